@@ -142,9 +142,12 @@ static void dumppacket (const TCHAR *n, uae_u8 *packet, int len)
 }
 #endif
 
-#define MAX_PACKET_SIZE 4000
-static uae_u8 transmitbuffer[MAX_PACKET_SIZE];
-static volatile int transmitlen;
+#define MAX_PACKET_SIZE ETHERNET_RING_FRAME
+// frames received from the backend, drained on hsync
+static struct ethernet_ring rxring;
+// frames waiting for the backend to pick them up
+static struct ethernet_ring txring;
+static uae_u32 rx_frames, rx_batches, tx_frames;
 
 static int dofakemac (uae_u8 *packet)
 {
@@ -281,31 +284,29 @@ static void put_ram_word(uae_u32 offset, uae_u16 v)
 	put_ram_byte(offset + 1, (uae_u8)v);
 }
 
-static void gotfunc (void *devv, const uae_u8 *databuf, int len)
+// d is the receive ring slot, rewritten in place. gotfunc() leaves room for the FCS.
+static void a2065_receive (uae_u8 *d, int len)
 {
 	int i;
 	int size, insize, first;
 	uae_u32 addr, off;
-	uae_u8 *d;
 	uae_u16 rmd0, rmd1, rmd2, rmd3;
 	uae_u32 crc32;
-	uae_u8 tmp[MAX_PACKET_SIZE], *data;
 	const uae_u8 *dstmac, *srcmac;
-	struct s2devstruct *dev = (struct s2devstruct*)devv;
 
 	if (!am_initialized)
 		return;
 	if (!am_rdr_rlen)
 		return;
 
-	dstmac = databuf;
-	srcmac = databuf + 6;
+	dstmac = d;
+	srcmac = d + 6;
 
 	if (log_a2065 > 1 && log_receive) {
 		write_log (_T("7790<!DST:%02X.%02X.%02X.%02X.%02X.%02X SRC:%02X.%02X.%02X.%02X.%02X.%02X E=%04X S=%d\n"),
 			dstmac[0], dstmac[1], dstmac[2], dstmac[3], dstmac[4], dstmac[5],
 			srcmac[6], srcmac[7], srcmac[8], srcmac[9], srcmac[10], srcmac[11],
-			(databuf[12] << 8) | databuf[13], len);
+			(d[12] << 8) | d[13], len);
 	}
 
 	if (!(csr[0] & CSR0_RXON)) // receiver off?
@@ -351,25 +352,6 @@ static void gotfunc (void *devv, const uae_u8 *databuf, int len)
 		}
 	}
 
-	memcpy (tmp, databuf, len);
-#if 0
-	FILE *f = fopen("s:\\d\\wireshark2.cap", "rb");
-	fseek (f, 474, SEEK_SET);
-	fread (tmp, 342, 1, f);
-	fclose (f);
-	realmac[0] = 0xc8;
-	realmac[1] = 0x0a;
-	realmac[2] = 0xa9;
-	realmac[3] = 0x81;
-	realmac[4] = 0xff;
-	realmac[5] = 0x2f;
-	fakemac[3] = realmac[3];
-	fakemac[4] = realmac[4];
-	fakemac[5] = realmac[5];
-#endif
-	d = tmp;
-	dstmac = d;
-	srcmac = d + 6;
 	if (log_a2065 && log_receive) {
 		if (memcmp (dstmac, realmac, sizeof realmac) == 0) {
 			write_log (_T("7990<-DST:%02X.%02X.%02X.%02X.%02X.%02X SRC:%02X.%02X.%02X.%02X.%02X.%02X E=%04X S=%d\n"),
@@ -396,7 +378,6 @@ static void gotfunc (void *devv, const uae_u8 *databuf, int len)
 		d[len++] = crc32 >>  0;
 	}
 
-	data = tmp;
 	size = 0;
 	insize = 0;
 	first = 1;
@@ -435,7 +416,7 @@ static void gotfunc (void *devv, const uae_u8 *databuf, int len)
 		size = 65536 - rmd2;
 		uae_u8 *pr = boardram + addr;
 		for (i = 0; i < size && insize < len; i++, insize++) {
-			pr[(i ^ abyteswap) & RAM_MASK] = data[insize];
+			pr[(i ^ abyteswap) & RAM_MASK] = d[insize];
 		}
 		if (insize >= len) {
 			rmd1 |= RX_ENP;
@@ -453,27 +434,47 @@ static void gotfunc (void *devv, const uae_u8 *databuf, int len)
 	devices_rethink_all(rethink_a2065);
 }
 
+// backend: queue the frame, a2065_receive() runs on hsync
+static void gotfunc (void *devv, const uae_u8 *databuf, int len)
+{
+	struct ethernet_frame *f;
+
+	if (!am_initialized)
+		return;
+	if (len <= 0 || len > MAX_PACKET_SIZE - 4)
+		return;
+	f = ethernet_ring_alloc(&rxring);
+	if (!f) {
+		atomic_inc(&rxring.dropped);
+		return;
+	}
+	memcpy(f->data, databuf, len);
+	f->len = len;
+	ethernet_ring_commit(&rxring);
+}
+
 static int getfunc (void *devv, uae_u8 *d, int *len)
 {
-	struct s2devstruct *dev = (struct s2devstruct*)devv;
+	struct ethernet_frame *f;
 
 	if (!am_initialized)
 		return 0;
-	if (transmitlen <= 0)
+	f = ethernet_ring_peek(&txring);
+	if (!f)
 		return 0;
-	if (transmitlen > *len) {
-		write_log (_T("7990: too large packet transmission attempt %d > %d\n"), transmitlen, *len);
-		transmitlen = 0;
+	if (f->len > *len) {
+		write_log (_T("7990: too large packet transmission attempt %d > %d\n"), f->len, *len);
+		ethernet_ring_release(&txring);
 		return 0;
 	}
-	memcpy (d, transmitbuffer, transmitlen);
-	*len = transmitlen;
-	transmitlen = 0;
+	memcpy (d, f->data, f->len);
+	*len = f->len;
+	ethernet_ring_release(&txring);
 	transmitnow = 1;
 	return 1;
 }
 
-static void do_transmit (void)
+static bool do_transmit (void)
 {
 	int i;
 	int size, outsize;
@@ -481,13 +482,19 @@ static void do_transmit (void)
 	uae_u32 addr, bufaddr;
 	uae_u16 tmd0, tmd1, tmd2, tmd3;
 	uae_u32 off;
+	struct ethernet_frame *f;
+	uae_u8 *transmitbuffer;
 
 	err = 0;
 	size = 0;
 	outsize = 0;
 
 	if (!am_tdr_tlen)
-		return;
+		return false;
+	f = ethernet_ring_alloc(&txring);
+	if (!f)
+		return false;
+	transmitbuffer = f->data;
 
 	tdr_offset %= am_tdr_tlen;
 	bufaddr = am_tdr_tdra + tdr_offset * 8;
@@ -495,7 +502,7 @@ static void do_transmit (void)
 	tmd1 = get_ram_word(off + 2);
 	if (!(tmd1 & TX_OWN) || !(tmd1 & TX_STP)) {
 		tdr_offset++;
-		return;
+		return false;
 	}
 	if (!(tmd1 & TX_ENP) && log_a2065 > 0)
 		write_log (_T("7990: chained transmit!?\n"));
@@ -560,8 +567,8 @@ static void do_transmit (void)
 				d[6], d[7], d[8], d[9], d[10], d[11],
 				(d[12] << 8) | d[13], outsize, bufaddr);
 		}
-		transmitlen = outsize;
-		if (mungepacket (d, transmitlen)) {
+		f->len = outsize;
+		if (mungepacket (d, outsize)) {
 			if (log_a2065 && log_transmit) {
 				write_log (_T("7990*>DST:%02X.%02X.%02X.%02X.%02X.%02X SRC:%02X.%02X.%02X.%02X.%02X.%02X E=%04X S=%d\n"),
 					d[0], d[1], d[2], d[3], d[4], d[5],
@@ -569,31 +576,49 @@ static void do_transmit (void)
 					(d[12] << 8) | d[13], outsize);
 			}
 		}
+		ethernet_ring_commit(&txring);
+		tx_frames++;
 		ethernet_trigger (td, sysdata);
 	}
 	csr[0] |= CSR0_TINT;
 	devices_rethink_all(rethink_a2065);
+	return true;
 }
 
-static void check_transmit(bool tdmd)
+static bool check_transmit(bool tdmd)
 {
-	if (transmitlen > 0)
-		return;
 	if (!(csr[0] & CSR0_TXON))
-		return;
+		return false;
 	if (AM79C960 && !tdmd && (csr[4] & 0x1000)) // DPOLL
-		return;
+		return false;
 	transmitnow = 0;
-	do_transmit ();
+	return do_transmit ();
 }
 
+#define TX_BATCH 8
+
 static void a2065_hsync_handler(void)
 {
 	static int cnt;
+	struct ethernet_frame *f;
+	int n = 0;
+
+	while ((f = ethernet_ring_peek(&rxring))) {
+		a2065_receive(f->data, f->len);
+		ethernet_ring_release(&rxring);
+		n++;
+	}
+	if (n) {
+		rx_frames += n;
+		rx_batches++;
+	}
 
 	cnt--;
 	if (cnt < 0 || transmitnow) {
-		check_transmit(false);
+		for (int i = 0; i < TX_BATCH; i++) {
+			if (!check_transmit(false))
+				break;
+		}
 		cnt = 15;
 	}
 }
@@ -1025,6 +1050,11 @@ static void a2065_reset(int hardreset)
 	am_initialized = 0;
 
 	ethernet_close(td, sysdata);
+	if (log_a2065 && rx_batches)
+		write_log(_T("7990: %u frames received in %u batches, %u dropped, %u sent\n"), rx_frames, rx_batches, rxring.dropped, tx_frames);
+	ethernet_ring_reset(&rxring);
+	ethernet_ring_reset(&txring);
+	rx_frames = rx_batches = tx_frames = 0;
 
 	for (int i = 0; i < RAP_SIZE; i++)
 		csr[i] = 0;
@@ -1044,6 +1074,8 @@ static void a2065_reset(int hardreset)
 static void a2065_free(void)
 {
 	a2065_reset(1);
+	ethernet_ring_free(&rxring);
+	ethernet_ring_free(&txring);
 }
 
 static bool a2065_config (struct autoconfig_info *aci)
@@ -1128,6 +1160,8 @@ static bool a2065_config (struct autoconfig_info *aci)
 
 	alloc_expansion_bank(&a2065_bank, aci);
 	boardram = a2065_bank.baseaddr + RAM_OFFSET;
+	ethernet_ring_init(&rxring);
+	ethernet_ring_init(&txring);
 
 	device_add_hsync(a2065_hsync_handler);
 	device_add_rethink(rethink_a2065);
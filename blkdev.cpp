@@ -11,6 +11,7 @@
 #include "sysdeps.h"
 #include "options.h"
 #include "memory.h"
+#include "newcpu.h"
 
 #include "traps.h"
 #include "blkdev.h"
@@ -2343,6 +2344,8 @@ int sys_command_scsi_direct(TrapContext *ctx, int unitnum, int type, uaecptr acm
 		if (!bank || !bank->check(ap, as.len))
 			return IOERR_BADADDRESS;
 		as.data = bank->xlateaddr (ap);
+		if (as.flags & 1)
+			compemu_unprotect(ap, as.len);
 	}
 
 	ap = get_long_host(scsicmd + 12);
@@ -2095,6 +2095,7 @@ void cfgfile_save_options (struct zfile *f, struct uae_prefs *p, int type)
 	cfgfile_write_bool (f, _T("compfpu"), p->compfpu);
 #endif
 	cfgfile_write_bool(f, _T("comp_catchfault"), p->comp_catchfault);
+	cfgfile_dwrite_bool(f, _T("comp_deferred"), p->comp_deferred);
 	cfgfile_write(f, _T("cachesize"), _T("%d"), p->cachesize);
 	cfgfile_dwrite_str(f, _T("jit_blacklist"), p->jitblacklist);
 
@@ -5611,6 +5612,7 @@ static int cfgfile_parse_hardware (struct uae_prefs *p, const TCHAR *option, TCH
 		|| cfgfile_yesno(option, value, _T("comp_nf"), &p->compnf)
 		|| cfgfile_yesno(option, value, _T("comp_constjump"), &p->comp_constjump)
 		|| cfgfile_yesno(option, value, _T("comp_catchfault"), &p->comp_catchfault)
+		|| cfgfile_yesno(option, value, _T("comp_deferred"), &p->comp_deferred)
 #ifdef USE_JIT_FPU
 		|| cfgfile_yesno (option, value, _T("compfpu"), &p->compfpu)
 #endif
@@ -7990,6 +7992,7 @@ void default_prefs (struct uae_prefs *p, bool reset, int type)
 	p->compfpu = 0;
 #endif
 	p->comp_catchfault = true;
+	p->comp_deferred = false;
 	p->cachesize = 0;
 
 	p->gfx_framerate = 1;
@@ -11,6 +11,8 @@
 
 #include "options.h"
 
+#include <process.h>
+
 #define MAX_REGISTERS 16
 
 #define EAFLAG_SP 1
@@ -73,6 +75,7 @@ static int feature_instruction_size = 0;
 static int fpu_min_exponent, fpu_max_exponent;
 static int max_file_size;
 static int rnd_seed, rnd_seed_prev;
+static int partition_index, partition_count, partition_variant;
 static TCHAR *feature_instruction_size_text = NULL;
 static uae_u32 feature_addressing_modes[2];
 static int feature_gzip = 0;
@@ -2045,6 +2048,9 @@ static void mergefiles(const TCHAR *dir)
 static void save_memory(const TCHAR *path, const TCHAR *name, uae_u8 *p, int size)
 {
 	TCHAR fname[1000];
+	// shared files are written by first partition only
+	if (partition_index > 0)
+		return;
 	_stprintf(fname, _T("%s%s"), path, name);
 	FILE *f = _tfopen(fname, _T("wb"));
 	if (!f) {
@@ -2059,6 +2065,8 @@ static void save_memory(const TCHAR *path, const TCHAR *name, uae_u8 *p, int siz
 static void deletefile(const TCHAR *path, const TCHAR *name)
 {
 	TCHAR path2[1000];
+	if (partition_index > 0)
+		return;
 	_tcscpy(path2, path);
 	_tcscat(path2, name);
 	_tcscat(path2, _T(".dat"));
@@ -4580,6 +4588,8 @@ static void test_mnemo(const TCHAR *path, const TCHAR *mnemo, const TCHAR *ovrfi
 		}
 	}
 	xorshiftstate ^= rnd_seed;
+	// each test set has its own random state, output does not depend on previous sets
+	rand8_cnt = rand16_cnt = rand32_cnt = 0;
 
 	int pathlen = _tcslen(path);
 	_stprintf(dir, _T("%s%s"), path, mns);
@@ -4625,6 +4635,12 @@ static void test_mnemo(const TCHAR *path, const TCHAR *mnemo, const TCHAR *ovrfi
 	if (!opcodecnt)
 		return;
 
+	if (partition_count > 1) {
+		int part = partition_variant++ % partition_count;
+		if (part != partition_index)
+			return;
+	}
+
 	wprintf(_T("%s\n"), dir);
 
 	int quick = 0;
@@ -7390,8 +7406,50 @@ static int test(struct ini_data *ini, const TCHAR *sections, const TCHAR *testna
 
 static TCHAR sections[1000];
 
+static int spawn_partitions(const char *exe, int workers)
+{
+	intptr_t *handles = xcalloc(intptr_t, workers);
+	char part[32];
+	int failed = 0;
+
+	for (int i = 0; i < workers; i++) {
+		const char *args[] = { exe, "-p", part, NULL };
+		sprintf(part, "%d/%d", i, workers);
+		handles[i] = _spawnv(_P_NOWAIT, exe, args);
+		if (handles[i] == -1) {
+			wprintf(_T("Couldn't start partition %d/%d\n"), i, workers);
+			failed = 1;
+		}
+	}
+	for (int i = 0; i < workers; i++) {
+		int status = 0;
+		if (handles[i] == -1)
+			continue;
+		_cwait(&status, handles[i], _WAIT_CHILD);
+		if (status)
+			failed = 1;
+	}
+	xfree(handles);
+	return failed;
+}
+
 int __cdecl main(int argc, char *argv[])
 {
+	int workers = 0;
+	for (int i = 1; i < argc; i++) {
+		if (!_stricmp(argv[i], "-j") && i + 1 < argc) {
+			workers = atoi(argv[++i]);
+		} else if (!_stricmp(argv[i], "-p") && i + 1 < argc) {
+			if (sscanf(argv[++i], "%d/%d", &partition_index, &partition_count) != 2 ||
+				partition_count < 1 || partition_index < 0 || partition_index >= partition_count) {
+				wprintf(_T("Invalid partition '%S'\n"), argv[i]);
+				return 0;
+			}
+		}
+	}
+	if (workers > 1 && !partition_count)
+		return spawn_partitions(argv[0], workers);
+
 	struct ini_data *ini = ini_load(_T("cputestgen.ini"), false);
 	if (!ini) {
 		wprintf(_T("Couldn't open cputestgen.ini\n"));
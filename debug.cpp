@@ -175,6 +175,7 @@ static const TCHAR help[] = {
 	_T("  r                     Dump state of the CPU.\n")
 	_T("  r <reg> <value>       Modify CPU registers (Dx,Ax,USP,ISP,VBR,...).\n")
 	_T("  rc[d]                 Show CPU instruction or data cache contents.\n")
+	_T("  rj                    Show JIT translation cache statistics.\n")
 	_T("  m <address> [<lines>] Memory dump starting at <address>.\n")
 	_T("  a <address>           Assembler.\n")
 	_T("  d <address> [<lines>] Disassembly starting at <address>.\n")
@@ -6125,6 +6126,10 @@ static bool debug_line (TCHAR *input)
 			if (*inptr == 'c') {
 				next_char(&inptr);
 				m68k_dumpcache(*inptr == 'd');
+#ifdef JIT
+			} else if (*inptr == 'j') {
+				compemu_dumpstats();
+#endif
 			} else if (*inptr == 's') {
 				if (*(inptr + 1) == 's')
 					debugmem_list_stackframe(true);
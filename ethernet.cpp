@@ -65,6 +65,7 @@ void slirp_output (const uint8_t *pkt, int pkt_len)
 	if (!slirp_data)
 		return;
 	gui_flicker_led(LED_NET, 0, gui_data.net | 1);
+	// QEMU slirp thread and synchronous replies on the emulation thread both get here
 	uae_sem_wait (&slirp_sem1);
 	slirp_data->gotfunc (slirp_data->userdata, pkt, pkt_len);
 	uae_sem_post (&slirp_sem1);
@@ -84,13 +85,13 @@ void ethernet_trigger (struct netdriverdata *ndd, void *vsd)
 			if (slirp_data) {
 				uae_u8 pkt[4000];
 				int len = sizeof pkt;
-				int v;
-				uae_sem_wait (&slirp_sem1);
-				v = slirp_data->getfunc(ed->userdata, pkt, &len);
-				uae_sem_post (&slirp_sem1);
-				if (v) {
+				// feed everything the device has queued under one lock
+				if (slirp_data->getfunc(ed->userdata, pkt, &len)) {
 					uae_sem_wait (&slirp_sem2);
-					uae_slirp_input(pkt, len);
+					do {
+						uae_slirp_input(pkt, len);
+						len = sizeof pkt;
+					} while (slirp_data->getfunc(ed->userdata, pkt, &len));
 					uae_sem_post (&slirp_sem2);
 				}
 			}
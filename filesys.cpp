@@ -5511,6 +5511,7 @@ static void	action_read(TrapContext *ctx, Unit *unit, dpacket *packet)
 
 			/* normal fast read */
 			uae_u8 *realpt = get_real_address (addr);
+			compemu_unprotect(addr, size);
 			actual = fs_read (k->fd, realpt, size);
 
 		}
@@ -310,9 +310,14 @@ static void harlequin_convert(struct fb_struct *data)
 	int sy = 0;
 	int w = vidinfo->width < data->width ? vidinfo->width : data->width;
 	int h = vidinfo->height < data->height ? vidinfo->height : data->height;
+	uae_u8 **rows = NULL;
+	if (r && g && b)
+		rows = xmalloc(uae_u8*, h);
 	for (int y = 0; y < h; y++) {
 		uae_u8 *s = data->fb + offset + laceoffset + sy * data->width * 4;
-		if (r && g && b) {
+		if (rows) {
+			rows[y] = s;
+		} else if (r && g && b) {
 			fb_copyrow(data->monitor_id, s, data->surface, 0, 0, data->width, 4, y);
 		} else {
 			uae_u8 tmp[1000 * 4];
@@ -333,6 +338,10 @@ static void harlequin_convert(struct fb_struct *data)
 			sy++;
 		}
 	}
+	if (rows) {
+		fb_copyrows(data->monitor_id, rows, data->surface, data->width, h, 4);
+		xfree(rows);
+	}
 }
 
 static bool harlequin_vsync(void *userdata, struct gfxboard_mode *mode)
@@ -55,6 +55,7 @@ static bool memlogw = true;
 #include "pcem/pcemglue.h"
 #include "qemuvga/qemuuaeglue.h"
 #include "qemuvga/vga.h"
+#include "vramwatch.h"
 
 extern void put_io_pcem(uaecptr, uae_u32, int);
 extern uae_u32 get_io_pcem(uaecptr, int);
@@ -1343,6 +1344,9 @@ void qemu_console_resize(QemuConsole *con, int width, int height)
 
 void linear_memory_region_set_dirty(MemoryRegion *mr, hwaddr addr, hwaddr size)
 {
+	struct rtggfxboard *gb = (struct rtggfxboard*)mr->data;
+	if (size)
+		vramwatch_mark(gb->rtg_index, (uae_u32)addr, (int)size);
 }
 
 void vga_memory_region_set_dirty(MemoryRegion *mr, hwaddr addr, hwaddr size)
@@ -2165,6 +2169,7 @@ static void gfxboard_lput_vram (struct rtggfxboard *gb, uaecptr addr, uae_u32 l,
 		}
 	} else {
 		uae_u8 *m = gb->vram + addr;
+		vramwatch_mark(gb->rtg_index, addr, 4);
 		if (bs < 0) {
 			*((uae_u16*)(m + 0)) = l >> 16;
 			*((uae_u16*)(m + 2)) = l >>  0;
@@ -2199,6 +2204,7 @@ static void gfxboard_wput_vram (struct rtggfxboard *gb, uaecptr addr, uae_u16 w,
 		}
 	} else {
 		uae_u8 *m = gb->vram + addr;
+		vramwatch_mark(gb->rtg_index, addr, 2);
 		if (bs)
 			*((uae_u16*)m) = w;
 		else
@@ -2228,6 +2234,7 @@ static void gfxboard_bput_vram (struct rtggfxboard *gb, uaecptr addr, uae_u8 b,
 		else
 			bank->write(&gb->vga, addr, b, 1);
 	} else {
+		vramwatch_mark(gb->rtg_index, addr, 1);
 		if (bs)
 			gb->vram[addr ^ 1] = b;
 		else
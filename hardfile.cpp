@@ -1315,6 +1315,7 @@ static uae_u64 cmd_read(TrapContext *ctx, struct hardfiledata *hfd, uaecptr data
 			return 0;
 		if (bank_data->check(dataptr, (uae_u32)len)) {
 			uae_u8 *buffer = bank_data->xlateaddr(dataptr);
+			compemu_unprotect(dataptr, (uae_u32)len);
 			return cmd_readx(hfd, buffer, offset, (uae_u32)len);
 		}
 	}
@@ -74,7 +74,6 @@ struct socketbase {
     unsigned int *mtable;	/* window messages allocated for asynchronous event notification */
     /* host-specific fields below */
 #ifdef _WIN32
-    SOCKET_TYPE sockAbort;	/* for aborting WinSock2 select() (damn Microsoft) */
     SOCKET_TYPE sockAsync;	/* for aborting WSBAsyncSelect() in window message handler */
     int needAbort;		/* abort flag */
     void *hAsyncTask;		/* async task handle */
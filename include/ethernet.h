@@ -20,6 +20,81 @@ struct netdriverdata
 };
 
 
+/* Single producer, single consumer frame ring between an emulated
+ * network chip and its backend thread. Producer only advances wrp,
+ * consumer only advances rdp, so neither side takes a lock. Backends
+ * that can produce from more than one thread must serialize the
+ * producer calls themselves. */
+#define ETHERNET_RING_SLOTS 64
+#define ETHERNET_RING_FRAME 4000
+
+struct ethernet_frame
+{
+	int len;
+	uae_u8 data[ETHERNET_RING_FRAME];
+};
+
+struct ethernet_ring
+{
+	struct ethernet_frame *frames;
+	volatile uae_atomic wrp;
+	volatile uae_atomic rdp;
+	volatile uae_atomic dropped;
+};
+
+STATIC_INLINE bool ethernet_ring_init(struct ethernet_ring *r)
+{
+	if (!r->frames)
+		r->frames = xcalloc(struct ethernet_frame, ETHERNET_RING_SLOTS);
+	r->wrp = r->rdp = 0;
+	r->dropped = 0;
+	return r->frames != NULL;
+}
+
+STATIC_INLINE void ethernet_ring_free(struct ethernet_ring *r)
+{
+	xfree(r->frames);
+	r->frames = NULL;
+}
+
+/* Both sides must be idle. */
+STATIC_INLINE void ethernet_ring_reset(struct ethernet_ring *r)
+{
+	r->wrp = r->rdp = 0;
+	r->dropped = 0;
+}
+
+STATIC_INLINE int ethernet_ring_count(struct ethernet_ring *r)
+{
+	return (uae_u32)r->wrp - (uae_u32)r->rdp;
+}
+
+/* Producer: get a free slot, fill it, then ethernet_ring_commit(). */
+STATIC_INLINE struct ethernet_frame *ethernet_ring_alloc(struct ethernet_ring *r)
+{
+	if (!r->frames || ethernet_ring_count(r) >= ETHERNET_RING_SLOTS)
+		return NULL;
+	return &r->frames[(uae_u32)r->wrp % ETHERNET_RING_SLOTS];
+}
+
+STATIC_INLINE void ethernet_ring_commit(struct ethernet_ring *r)
+{
+	atomic_inc(&r->wrp);
+}
+
+/* Consumer: get the oldest frame, then ethernet_ring_release() it. */
+STATIC_INLINE struct ethernet_frame *ethernet_ring_peek(struct ethernet_ring *r)
+{
+	if (!r->frames || r->rdp == r->wrp)
+		return NULL;
+	return &r->frames[(uae_u32)r->rdp % ETHERNET_RING_SLOTS];
+}
+
+STATIC_INLINE void ethernet_ring_release(struct ethernet_ring *r)
+{
+	atomic_inc(&r->rdp);
+}
+
 typedef void (ethernet_gotfunc)(void *dev, const uae_u8 *data, int len);
 typedef int (ethernet_getfunc)(void *dev, uae_u8 *d, int *len);
 
@@ -826,8 +826,12 @@ extern cpuop_func *cpufunctbl[65536] ASM_SYM_FOR_FUNC ("cpufunctbl");
 #ifdef JIT
 extern void (*flush_icache)(int);
 extern void compemu_reset(void);
+extern void compemu_unprotect(uaecptr addr, uae_u32 size);
+extern void compemu_dumpstats(void);
+extern void compemu_sample(void);
 #else
 #define flush_icache(int) do {} while (0)
+#define compemu_unprotect(addr, size) do {} while (0)
 #define flush_icache_hard(int) do {} while (0)
 #endif
 bool check_prefs_changed_comp (bool);
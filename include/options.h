@@ -543,6 +543,7 @@ struct uae_prefs {
 	bool comp_hardflush;
 	bool comp_constjump;
 	bool comp_catchfault;
+	bool comp_deferred;
 	int cachesize;
 	TCHAR jitblacklist[MAX_DPATH];
 	bool fpu_strict;
@@ -215,6 +215,7 @@ uae_atomic atomic_and(volatile uae_atomic *p, uae_u32 v);
 uae_atomic atomic_or(volatile uae_atomic *p, uae_u32 v);
 uae_atomic atomic_inc(volatile uae_atomic *p);
 uae_atomic atomic_dec(volatile uae_atomic *p);
+uae_atomic atomic_cmpxchg(volatile uae_atomic *p, uae_u32 v, uae_u32 cmp);
 uae_u32 atomic_bit_test_and_reset(volatile uae_atomic *p, uae_u32 v);
 
 #ifdef HAVE_STRDUP
@@ -10,6 +10,7 @@
 #define UAE_VM_H
 
 #include "uae/types.h"
+#include <stdio.h>
 
 #define UAE_VM_WRITE 2
 #define UAE_VM_EXECUTE 4
@@ -44,6 +45,10 @@ bool uae_vm_decommit(void *address, uae_u32 size);
 
 int uae_vm_page_size(void);
 
+/* Read-only mapping of a whole open file. */
+void *uae_vm_map_file(FILE *f, uae_u64 size);
+void uae_vm_unmap_file(void *address, uae_u64 size);
+
 // void *uae_vm_alloc_with_flags(uae_u32 size, int protect, int flags);
 
 #endif /* UAE_VM_H */
@@ -0,0 +1,20 @@
+#ifndef UAE_VRAMWATCH_H
+#define UAE_VRAMWATCH_H
+
+#include "uae/types.h"
+
+/*
+ * RTG VRAM dirty page tracking. Offsets are relative to board VRAM start,
+ * base is the host address of board VRAM.
+ */
+
+extern void vramwatch_alloc(int index, uae_u32 size);
+extern void vramwatch_free(int index);
+extern int vramwatch_shift(int index);
+/* mark VRAM written by code that does not go through natmem */
+extern void vramwatch_mark(int index, uae_u32 offset, int size);
+/* returns non-zero if dirty pages can't be tracked, caller must refresh everything */
+extern int vramwatch_region(int index, uae_u8 *base, uae_u8 *start, uae_u32 size, void **buf, uae_u32 *cnt);
+extern void vramwatch_reset(int index, uae_u8 *base, uae_u32 size);
+
+#endif /* UAE_VRAMWATCH_H */
@@ -6,6 +6,7 @@
 typedef uae_s64 (*ZFILEREAD)(void*, uae_u64, uae_u64, struct zfile*);
 typedef uae_s64 (*ZFILEWRITE)(const void*, uae_u64, uae_u64, struct zfile*);
 typedef uae_s64 (*ZFILESEEK)(struct zfile*, uae_s64, int);
+typedef void (*ZFILECLOSE)(struct zfile*);
 
 struct zfile {
     TCHAR *name;
@@ -14,6 +15,7 @@ struct zfile {
 	TCHAR *originalname;
     FILE *f; // real file handle if physical file
     uae_u8 *data; // unpacked data
+    uae_u8 *mapped; // read-only memory mapping of physical file
     int dataseek; // use seek position even if real file
 	struct zfile *archiveparent; // set if parent is archive and this has not yet been unpacked (datasize < size)
 	int archiveid;
@@ -31,6 +33,7 @@ struct zfile {
     ZFILEREAD zfileread;
     ZFILEWRITE zfilewrite;
     ZFILESEEK zfileseek;
+    ZFILECLOSE zfileclose; // frees userdata internals
     void *userdata;
     int useparent;
 };
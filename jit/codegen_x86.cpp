@@ -123,6 +123,7 @@ uae_s8 can_byte[]={0,1,2,3,-1};
 uae_s8 can_word[]={0,1,2,3,5,6,7,-1};
 #endif
 static bool		have_lahf_lm		= true;		// target has LAHF supported in long mode ?
+bool			have_sse41			= false;	// target has SSE4.1 (ROUNDSD) ?
 
 #if USE_OPTIMIZED_CALLS
 /* Make sure interpretive core does not use cpuopti */
@@ -1773,8 +1774,9 @@ static void raw_init_cpu(void)
 	/* Intel-defined flags: level 0x00000001 */
 	c->x86_brand_id = 0;
 	if ( c->cpuid_level >= 0x00000001 ) {
-		uae_u32 tfms, brand_id;
-		cpuid(0x00000001, &tfms, &brand_id, &dummy, &c->x86_hwcap);
+		uae_u32 tfms, brand_id, ext_hwcap;
+		cpuid(0x00000001, &tfms, &brand_id, &ext_hwcap, &c->x86_hwcap);
+		have_sse41 = (ext_hwcap & (1 << 19)) != 0;
 		c->x86 = (tfms >> 8) & 15;
 		if (c->x86 == 0xf)
 			c->x86 += (tfms >> 20) & 0xff; /* extended family */
@@ -2300,6 +2302,34 @@ LOWFUNC(NONE,NONE,2,raw_frndint_rr,(FW d, FR s))
 	}
 }
 
+/* x87 and SSE registers can only exchange values through memory.
+   Compiled code runs on one thread at a time, like the 'one' constant
+   below this needs no per-call storage. */
+static double fintrz_scratch;
+
+LOWFUNC(NONE,NONE,2,raw_fintrz_rr,(FW d, FR s))
+{
+	int ds;
+
+	/* Truncate with SSE4.1 ROUNDSD, no x87 control word switching.
+	   FP registers hold doubles (fptype), so the store is exact. */
+	usereg(s);
+	ds=stackpos(s);
+	emit_byte(0xd9);
+	emit_byte(0xc0+ds); /* duplicate source */
+	raw_fstpl(JITPTR &fintrz_scratch);
+	MOVSDmr(JITPTR &fintrz_scratch, X86_NOREG, X86_NOREG, 1, X86_XMM0);
+	emit_byte(0x66);
+	emit_byte(0x0f);
+	emit_byte(0x3a);
+	emit_byte(0x0b);
+	emit_byte(0xc0);
+	emit_byte(0x03); /* roundsd xmm0,xmm0,3 (toward zero) */
+	MOVSDrm(X86_XMM0, JITPTR &fintrz_scratch, X86_NOREG, X86_NOREG, 1);
+	raw_fldl(JITPTR &fintrz_scratch);
+	tos_make(d);
+}
+
 LOWFUNC(NONE,NONE,2,raw_fcos_rr,(FW d, FR s))
 {
 	int ds;
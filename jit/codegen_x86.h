@@ -1843,6 +1843,9 @@ enum {
 #define MOVAPSmr(MD, MB, MI, MS, RD)	_SSEPSmr(0x28, MD, MB, MI, MS, RD)
 #define MOVAPSrm(RS, MD, MB, MI, MS)	_SSEPSrm(0x29, RS, MD, MB, MI, MS)
 
+#define MOVSDmr(MD, MB, MI, MS, RD)	_SSESDmr(0x10, MD, MB, MI, MS, RD)
+#define MOVSDrm(RS, MD, MB, MI, MS)	_SSESDrm(0x11, RS, MD, MB, MI, MS)
+
 #define MOVAPDrr(RS, RD)		_SSEPDrr(0x28, RS, RD)
 #define MOVAPDmr(MD, MB, MI, MS, RD)	_SSEPDmr(0x28, MD, MB, MI, MS, RD)
 #define MOVAPDrm(RS, MD, MB, MI, MS)	_SSEPDrm(0x29, RS, MD, MB, MI, MS)
@@ -155,6 +155,9 @@ union cacheline {
 #endif
 #endif
 #define N_FREGS 6 /* That leaves us two positions on the stack to play with */
+#if defined(CPU_i386) || defined(CPU_x86_64)
+extern bool have_sse41;
+#endif
 
 /* Functions exposed to newcpu, or to what was moved from newcpu.c to
  * compemu_support.c */
@@ -483,6 +486,7 @@ typedef struct blockinfo_t {
     uae_u8 needed_flags;
     uae_u8 status;
     uae_u8 havestate;
+    uae_u8 pageprot;
 
     dependency  dep[2];  /* Holds things we depend on */
     dependency* deplist; /* List of things that depend on this */
@@ -516,6 +520,9 @@ static inline void flush_icache(void) { }
 
 #define JIT_EXCEPTION_HANDLER
 // #define JIT_ALWAYS_DISTRUST
+#if defined(_WIN32) && defined(NATMEM_OFFSET)
+#define JIT_PAGE_PROTECT
+#endif
 
 /* ARAnyM uses fpu_register name, used in scratch_t */
 /* FIXME: check that no ARAnyM code assumes different floating point type */
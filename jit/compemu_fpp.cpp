@@ -1572,6 +1572,20 @@ void comp_fpp_opp(uae_u32 opcode, uae_u16 extra)
 				FAIL(1);
 				return;
 			}
+#if defined(CPU_i386) || defined(CPU_x86_64)
+			if (have_sse41) {
+				dont_care_fflags();
+				src = get_fp_value(opcode, extra);
+				if (src < 0)
+				{
+					FAIL(1);			/* Illegal instruction */
+					return;
+				}
+				fintrz_rr(reg, src);
+				MAKE_FPSR(reg);
+				break;
+			}
+#endif
 #ifdef USE_X86_FPUCW
 			/* If we have control over the CW, we can do this */
 			dont_care_fflags();
@@ -2637,6 +2637,15 @@ MIDFUNC(2,fetox_rr,(FW d, FR s))
 	f_unlock(d);
 }
 
+MIDFUNC(2,fintrz_rr,(FW d, FR s))
+{
+	s=f_readreg(s);
+	d=f_writereg(d);
+	raw_fintrz_rr(d,s);
+	f_unlock(s);
+	f_unlock(d);
+}
+
 MIDFUNC(2,frndint_rr,(FW d, FR s))
 {
 	s=f_readreg(s);
@@ -223,6 +223,7 @@ DECLARE_MIDFUNC(dont_care_fflags(void));
 DECLARE_MIDFUNC(fsqrt_rr(FW d, FR s));
 DECLARE_MIDFUNC(fabs_rr(FW d, FR s));
 DECLARE_MIDFUNC(frndint_rr(FW d, FR s));
+DECLARE_MIDFUNC(fintrz_rr(FW d, FR s));
 DECLARE_MIDFUNC(fgetexp_rr(FW d, FR s));
 DECLARE_MIDFUNC(fgetman_rr(FW d, FR s));
 DECLARE_MIDFUNC(fsin_rr(FW d, FR s));
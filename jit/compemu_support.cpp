@@ -380,6 +380,57 @@ int segvcount=0;
 static uae_u8* current_compile_p=NULL;
 static uae_u8* max_compile_start;
 static uae_u8* compiled_code=NULL;
+
+/* Translation cache is split into segments that are filled in turn.
+   When the last one is full, the coldest segment is evicted instead of
+   flushing everything. */
+#define CACHE_SEGMENTS 8
+#define CACHE_SEGMENT_MIN_SIZE (256 * 1024)
+static int cache_segments;
+static int cache_segment;
+static uae_u32 cache_segment_size;
+static bool cache_segment_used[CACHE_SEGMENTS];
+static uae_u32 cache_segment_heat[CACHE_SEGMENTS];
+static uae_u32 cache_segment_age[CACHE_SEGMENTS], cache_segment_seq;
+
+static uae_u32 jit_stat_hardflushes, jit_stat_evictions, jit_stat_evicted_blocks;
+static uae_u32 jit_stat_compiles, jit_stat_recompiles;
+static uae_u32 jit_stat_samples, jit_stat_sample_hits;
+
+/* Instruction fusion. TST.x Dn or CMPI.x #0,Dn directly after an
+   instruction that set N and Z from the same Dn value is dropped, flag
+   liveness passes through it so the first instruction produces the
+   flags for the following Bcc/Scc/DBcc. ADD/SUB/NEG leave V and C set,
+   they only fuse when nothing reads V or C before they are set again.
+   CMP+Bcc, SUBQ+Bcc and DBcc already end up as host cmp/sub+jcc as the
+   flags stay in the host flags register up to the block end. */
+enum {
+	FUSE_NONE,
+	FUSE_MOVE_TST,
+	FUSE_LOGIC_TST,
+	FUSE_EXT_TST,
+	FUSE_ARITH_TST,
+	FUSE_MOVE_CMP0,
+	FUSE_LOGIC_CMP0,
+	FUSE_EXT_CMP0,
+	FUSE_ARITH_CMP0,
+	FUSE_PATTERNS
+};
+static const TCHAR *fuse_names[FUSE_PATTERNS] = {
+	NULL, _T("move+tst"), _T("logic+tst"), _T("ext+tst"), _T("arith+tst"),
+	_T("move+cmpi0"), _T("logic+cmpi0"), _T("ext+cmpi0"), _T("arith+cmpi0")
+};
+static uae_u32 jit_stat_fused[FUSE_PATTERNS];
+
+/* Per frame compile budget (comp_deferred). Once compiling has used a
+   quarter of the frame, new blocks keep running in the interpreter
+   until the next frame. Compiling stays on the CPU thread, the JIT
+   state (register allocator, cache pointers, block lists) is not
+   thread safe. */
+static uae_u32 compile_budget_frame;
+static frame_time_t compile_frame_time;
+static frame_time_t jit_stat_compile_frame_max;
+static uae_u32 jit_stat_deferred;
 static uae_s32 reg_alloc_run;
 const int POPALLSPACE_SIZE = 2048; /* That should be enough space */
 static uae_u8 *popallspace=NULL;
@@ -747,6 +798,235 @@ static inline void block_need_recompile(blockinfo * bi)
 	bi->status = BI_NEED_RECOMP;
 }
 
+#ifdef JIT_PAGE_PROTECT
+/* Self-modifying code detection: host pages of directly mapped RAM that
+   hold code of active blocks are write protected. A write only marks the
+   page dirty. At the next cache flush blocks on clean pages stay active,
+   blocks touching dirty pages get checksummed as usual. */
+
+#define PAGEPROT_SHIFT 12
+#define PAGEPROT_SIZE (1 << PAGEPROT_SHIFT)
+#define PAGEPROT_CLEAN 1
+#define PAGEPROT_DIRTY 2
+
+static volatile uae_u8 *pageprot_state;
+static uae_u32 pageprot_pages, pageprot_lo, pageprot_hi;
+static volatile uae_atomic pageprot_dirty;
+static volatile uae_atomic pageprot_faults;
+static uae_u32 pageprot_invalidated, pageprot_kept;
+static uae_u64 pageprot_kept_bytes;
+
+static bool pageprot_install(void);
+
+static void pageprot_init(void)
+{
+	uae_u32 pages = natmem_reserved_size >> PAGEPROT_SHIFT;
+
+	if (pageprot_faults || pageprot_invalidated || pageprot_kept) {
+		jit_log("JIT: page protection: %u faults, %u blocks invalidated, %u checksums skipped (%llu KB)",
+			pageprot_faults, pageprot_invalidated, pageprot_kept, pageprot_kept_bytes >> 10);
+	}
+	pageprot_faults = 0;
+	pageprot_invalidated = 0;
+	pageprot_kept = 0;
+	pageprot_kept_bytes = 0;
+
+	if (pageprot_state && pages == pageprot_pages)
+		return;
+	xfree((void*)pageprot_state);
+	pageprot_state = NULL;
+	pageprot_pages = 0;
+	if (!natmem_reserved || !pages || uae_vm_page_size() != PAGEPROT_SIZE)
+		return;
+	if (!pageprot_install()) {
+		jit_log("JIT: page protection disabled, no exception handler");
+		return;
+	}
+	pageprot_state = xcalloc(uae_u8, pages);
+	pageprot_pages = pages;
+	pageprot_lo = pages;
+	pageprot_hi = 0;
+}
+
+/* Only the faulting view is protected: memory that is also mapped at
+   another natmem address (chip RAM mirrors, 24-bit mirrors) keeps using
+   checksums. */
+static bool pageprot_mirrored(uae_u8 *p)
+{
+	shmpiece *x;
+
+	for (x = shm_start; x; x = x->next) {
+		if (p >= x->native_address && p < x->native_address + x->size)
+			break;
+	}
+	if (!x)
+		return true;
+	for (shmpiece *y = shm_start; y; y = y->next) {
+		if (y != x && y->id == x->id)
+			return true;
+	}
+	return false;
+}
+
+static bool pageprot_page_ok(uae_u8 *p)
+{
+	uaecptr addr = (uaecptr)(p - natmem_offset);
+	addrbank *ab = &get_mem_bank(addr);
+
+	if (!(ab->flags & ABFLAG_RAM) || (ab->flags & (ABFLAG_INDIRECT | ABFLAG_ALLOCINDIRECT | ABFLAG_RTG)))
+		return false;
+	if (!ab->baseaddr || get_real_address(addr) != p)
+		return false;
+	return !pageprot_mirrored(p);
+}
+
+/* Called when a block becomes active */
+static void pageprot_block(blockinfo *bi)
+{
+	bi->pageprot = 0;
+	if (!pageprot_state || !canbang || !lazy_flush || !bi->csi)
+		return;
+	for (checksum_info *csi = bi->csi; csi; csi = csi->next) {
+		if (!csi->length)
+			continue;
+		if (csi->start_p < natmem_reserved)
+			return;
+		uintptr_t start = csi->start_p - natmem_reserved;
+		uintptr_t end = start + csi->length - 1;
+		if ((end >> PAGEPROT_SHIFT) >= pageprot_pages)
+			return;
+		for (uae_u32 pg = start >> PAGEPROT_SHIFT; pg <= (end >> PAGEPROT_SHIFT); pg++) {
+			uae_u8 state = pageprot_state[pg];
+			if (state == PAGEPROT_CLEAN)
+				continue;
+			if (state == PAGEPROT_DIRTY)
+				return;
+			uae_u8 *p = natmem_reserved + ((uintptr_t)pg << PAGEPROT_SHIFT);
+			if (!pageprot_page_ok(p))
+				return;
+			pageprot_state[pg] = PAGEPROT_CLEAN;
+			if (!uae_vm_protect(p, PAGEPROT_SIZE, UAE_VM_READ)) {
+				pageprot_state[pg] = 0;
+				return;
+			}
+			if (pg < pageprot_lo)
+				pageprot_lo = pg;
+			if (pg > pageprot_hi)
+				pageprot_hi = pg;
+		}
+	}
+	bi->pageprot = 1;
+}
+
+/* Flush time: true if block code can't have been modified */
+static bool pageprot_block_clean(blockinfo *bi)
+{
+	uae_u32 bytes = 0;
+
+	if (!bi->pageprot)
+		return false;
+	for (checksum_info *csi = bi->csi; csi; csi = csi->next) {
+		if (!csi->length)
+			continue;
+		uintptr_t start = csi->start_p - natmem_reserved;
+		uintptr_t end = start + csi->length - 1;
+		for (uae_u32 pg = start >> PAGEPROT_SHIFT; pg <= (end >> PAGEPROT_SHIFT); pg++) {
+			if (pageprot_state[pg] != PAGEPROT_CLEAN) {
+				bi->pageprot = 0;
+				pageprot_invalidated++;
+				return false;
+			}
+		}
+		bytes += csi->length;
+	}
+	pageprot_kept++;
+	pageprot_kept_bytes += bytes;
+	return true;
+}
+
+/* Dirty pages stay writable until a block on them is reactivated */
+static void pageprot_flush(void)
+{
+	if (!pageprot_state || !pageprot_dirty)
+		return;
+	pageprot_dirty = 0;
+	for (uae_u32 pg = pageprot_lo; pg <= pageprot_hi; pg++) {
+		if (pageprot_state[pg] == PAGEPROT_DIRTY)
+			pageprot_state[pg] = 0;
+	}
+}
+
+static void pageprot_unprotect(uae_u32 pg)
+{
+	pageprot_state[pg] = PAGEPROT_DIRTY;
+	pageprot_dirty = 1;
+	uae_vm_protect(natmem_reserved + ((uintptr_t)pg << PAGEPROT_SHIFT), PAGEPROT_SIZE, UAE_VM_READ_WRITE);
+}
+
+static bool pageprot_fault(uintptr_t addr)
+{
+	if (!pageprot_state || addr < (uintptr_t)natmem_reserved)
+		return false;
+	uintptr_t pg = (addr - (uintptr_t)natmem_reserved) >> PAGEPROT_SHIFT;
+	if (pg >= pageprot_pages || !pageprot_state[pg])
+		return false;
+	pageprot_state[pg] = PAGEPROT_DIRTY;
+	pageprot_dirty = 1;
+	atomic_inc(&pageprot_faults);
+	return uae_vm_protect(natmem_reserved + (pg << PAGEPROT_SHIFT), PAGEPROT_SIZE, UAE_VM_READ_WRITE);
+}
+
+/* First chance handler, sees write faults from any thread (PPC, x86
+   bridge, TMS, network) even when the JIT handler is structured
+   exception handling that only covers the emulation thread. */
+static LONG CALLBACK pageprot_exception(PEXCEPTION_POINTERS info)
+{
+	PEXCEPTION_RECORD er = info->ExceptionRecord;
+	if (er->ExceptionCode == STATUS_ACCESS_VIOLATION && er->NumberParameters >= 2 && er->ExceptionInformation[0] == 1) {
+		if (pageprot_fault(er->ExceptionInformation[1]))
+			return EXCEPTION_CONTINUE_EXECUTION;
+	}
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static bool pageprot_install(void)
+{
+	static int installed;
+	if (!installed)
+		installed = AddVectoredExceptionHandler(1, pageprot_exception) ? 1 : -1;
+	return installed > 0;
+}
+#endif
+
+/* Must be called before the OS writes to Amiga memory (file, socket or
+   SCSI pass-through reads into natmem, memory remapping): kernel writes to
+   a protected page fail instead of raising an exception. Plain host code
+   writes from any thread (disk DMA, network, sound capture) fault and are
+   handled by pageprot_exception(). */
+void compemu_unprotect(uaecptr addr, uae_u32 size)
+{
+#ifdef JIT_PAGE_PROTECT
+	if (!pageprot_state || !size || pageprot_lo > pageprot_hi)
+		return;
+	uintptr_t base = (uintptr_t)natmem_reserved;
+	uintptr_t start = (uintptr_t)(natmem_offset + addr);
+	uintptr_t end = start + size - 1;
+	if (end < start)
+		end = UINTPTR_MAX;
+	if (end < base)
+		return;
+	uae_u32 lo = pageprot_lo, hi = pageprot_hi;
+	if (start > base && ((start - base) >> PAGEPROT_SHIFT) > lo)
+		lo = (uae_u32)((start - base) >> PAGEPROT_SHIFT);
+	if (((end - base) >> PAGEPROT_SHIFT) < hi)
+		hi = (uae_u32)((end - base) >> PAGEPROT_SHIFT);
+	for (uae_u32 pg = lo; pg <= hi; pg++) {
+		if (pageprot_state[pg] == PAGEPROT_CLEAN)
+			pageprot_unprotect(pg);
+	}
+#endif
+}
+
 #if USE_MATCH
 static inline void mark_callers_recompile(blockinfo * bi)
 {
@@ -3638,6 +3918,23 @@ static inline uint8 *alloc_code(uint32 size)
 	return ptr;
 }
 
+static void set_cache_segment(int seg)
+{
+	uae_u8 *end = seg == cache_segments - 1 ? compiled_code + cache_size * 1024 : compiled_code + (seg + 1) * cache_segment_size;
+
+	cache_segment = seg;
+	cache_segment_used[seg] = true;
+	cache_segment_heat[seg] = 0;
+	cache_segment_age[seg] = ++cache_segment_seq;
+	current_compile_p = compiled_code + seg * cache_segment_size;
+#ifdef USE_DATA_BUFFER
+	max_compile_start = end - BYTES_PER_INST - DATA_BUFFER_SIZE;
+	reset_data_buffer();
+#else
+	max_compile_start = end - BYTES_PER_INST;
+#endif
+}
+
 void alloc_cache(void)
 {
 	if (compiled_code) {
@@ -3661,17 +3958,16 @@ void alloc_cache(void)
 	vm_protect(compiled_code, cache_size * 1024, VM_PAGE_READ | VM_PAGE_WRITE | VM_PAGE_EXECUTE);
 	
 	if (compiled_code) {
-		jit_log("<JIT compiler> : actual translation cache size : %d KB at %p-%p", cache_size, compiled_code, compiled_code + cache_size*1024);
-#ifdef USE_DATA_BUFFER
-		max_compile_start = compiled_code + cache_size*1024 - BYTES_PER_INST - DATA_BUFFER_SIZE;
-#else
-		max_compile_start = compiled_code + cache_size*1024 - BYTES_PER_INST;
-#endif
-		current_compile_p = compiled_code;
+		cache_segments = cache_size * 1024 / CACHE_SEGMENT_MIN_SIZE;
+		if (cache_segments > CACHE_SEGMENTS)
+			cache_segments = CACHE_SEGMENTS;
+		if (cache_segments < 1)
+			cache_segments = 1;
+		cache_segment_size = (cache_size * 1024 / cache_segments) & ~4095;
+		jit_log("<JIT compiler> : actual translation cache size : %d KB at %p-%p, %d segments", cache_size, compiled_code, compiled_code + cache_size*1024, cache_segments);
+		memset(cache_segment_used, 0, sizeof cache_segment_used);
+		set_cache_segment(0);
 		current_cache_size = 0;
-#if defined(USE_DATA_BUFFER)
-		reset_data_buffer();
-#endif
 	}
 }
 
@@ -3821,6 +4117,9 @@ static inline int block_check_checksum(blockinfo* bi)
 		add_to_active(bi);
 		raise_in_cl_list(bi);
 		bi->status=BI_ACTIVE;
+#ifdef JIT_PAGE_PROTECT
+		pageprot_block(bi);
+#endif
 	}
 	else {
 		/* This block actually changed. We need to invalidate it,
@@ -4064,6 +4363,9 @@ static void prepare_block(blockinfo* bi)
 void compemu_reset(void)
 {
 	flush_icache = lazy_flush ? flush_icache_lazy : flush_icache_hard;
+#ifdef JIT_PAGE_PROTECT
+	pageprot_init();
+#endif
 	set_cache_state(0);
 }
 #endif
@@ -4508,11 +4810,9 @@ void flush_icache_hard(int v)
 	if (!compiled_code)
 		return;
 
-#if defined(USE_DATA_BUFFER)
-	reset_data_buffer();
-#endif
-
-	current_compile_p=compiled_code;
+	jit_stat_hardflushes++;
+	memset(cache_segment_used, 0, sizeof cache_segment_used);
+	set_cache_segment(0);
 #ifdef UAE
 	set_special(0); /* To get out of compiled code */
 #else
@@ -4520,6 +4820,164 @@ void flush_icache_hard(int v)
 #endif
 }
 
+static inline bool block_in_range(blockinfo *bi, uae_u8 *start, uae_u8 *end)
+{
+	uae_u8 *p;
+
+	p = (uae_u8*)bi->direct_pen;
+	if (p >= start && p < end)
+		return true;
+	p = (uae_u8*)bi->handler;
+	if (p >= start && p < end)
+		return true;
+	p = (uae_u8*)bi->direct_handler;
+	if (p >= start && p < end)
+		return true;
+	return false;
+}
+
+static int evict_blocks(blockinfo *list, uae_u8 *start, uae_u8 *end)
+{
+	blockinfo *bi, *dbi;
+	int cnt = 0;
+
+	/* Blocks outside of the segment that jump directly into it
+	   get invalidated and will be recompiled on next use */
+	for (bi = list; bi; bi = bi->next) {
+		if (!block_in_range(bi, start, end))
+			continue;
+		while (bi->deplist) {
+			dependency *x = bi->deplist;
+			blockinfo *cbi = x->source;
+			if (!block_in_range(cbi, start, end)) {
+				invalidate_block(cbi);
+				raise_in_cl_list(cbi);
+			} else {
+				remove_dep(x);
+			}
+		}
+	}
+	bi = list;
+	while (bi) {
+		dbi = bi;
+		bi = bi->next;
+		if (!block_in_range(dbi, start, end))
+			continue;
+		remove_deps(dbi);
+		remove_from_cl_list(dbi);
+		remove_from_list(dbi);
+		free_blockinfo(dbi);
+		cnt++;
+	}
+	return cnt;
+}
+
+static int cache_segment_of(void *p)
+{
+	uae_u8 *c = (uae_u8*)p;
+
+	if (c < compiled_code || c >= compiled_code + cache_size * 1024)
+		return -1;
+	int seg = (int)((c - compiled_code) / cache_segment_size);
+	return seg < cache_segments ? seg : cache_segments - 1;
+}
+
+/* Called each time compiled code returns to the main loop. The block at
+   the new PC counts as a use of its segment. This samples execution
+   without adding anything to compiled code. */
+void compemu_sample(void)
+{
+	if (cache_segments <= 1)
+		return;
+	jit_stat_samples++;
+	blockinfo *bi = get_blockinfo_addr(regs.pc_p);
+	if (!bi || bi->status == BI_INVALID)
+		return;
+	int seg = cache_segment_of(bi->direct_handler);
+	if (seg < 0)
+		return;
+	jit_stat_sample_hits++;
+	cache_segment_heat[seg]++;
+}
+
+/* Evict the coldest segment and continue compiling into it. Unused
+   segments go first, ties go to the segment filled longest ago. */
+static void next_cache_segment(void)
+{
+	int seg = -1;
+	int hold[MAX_HOLD_BI];
+	int holdcnt = 0;
+
+	if (cache_segments <= 1) {
+		flush_icache_hard(3);
+		return;
+	}
+	for (int i = 0; i < cache_segments; i++) {
+		if (i == cache_segment)
+			continue;
+		if (!cache_segment_used[i]) {
+			seg = i;
+			break;
+		}
+		if (seg < 0 || cache_segment_heat[i] < cache_segment_heat[seg] ||
+			(cache_segment_heat[i] == cache_segment_heat[seg] && cache_segment_age[i] < cache_segment_age[seg]))
+			seg = i;
+	}
+	if (cache_segment_used[seg]) {
+		uae_u8 *start = compiled_code + seg * cache_segment_size;
+		uae_u8 *end = seg == cache_segments - 1 ? compiled_code + cache_size * 1024 : start + cache_segment_size;
+		int cnt;
+
+		cnt = evict_blocks(active, start, end);
+		cnt += evict_blocks(dormant, start, end);
+		/* Spare blocks are in no list and have no cache tags, only their
+		   stubs are in the segment. They get new stubs below. */
+		for (int i = 0; i < MAX_HOLD_BI; i++) {
+			if (hold_bi[i] && block_in_range(hold_bi[i], start, end))
+				hold[holdcnt++] = i;
+		}
+		jit_stat_evictions++;
+		jit_stat_evicted_blocks += cnt;
+		/* older heat counts less */
+		for (int i = 0; i < cache_segments; i++)
+			cache_segment_heat[i] >>= 1;
+	}
+	set_cache_segment(seg);
+	for (int i = 0; i < holdcnt; i++)
+		prepare_block(hold_bi[hold[i]]);
+}
+
+void compemu_dumpstats(void)
+{
+	if (!compiled_code) {
+		console_out_f(_T("JIT not active.\n"));
+		return;
+	}
+	console_out_f(_T("Cache: %u KB, %d x %u KB segments, current %d, %u KB used\n"),
+		cache_size, cache_segments, cache_segment_size >> 10, cache_segment,
+		(uae_u32)((current_compile_p - (compiled_code + cache_segment * cache_segment_size)) >> 10));
+	console_out_f(_T("Hard flushes: %u, segment evictions: %u, evicted blocks: %u\n"),
+		jit_stat_hardflushes, jit_stat_evictions, jit_stat_evicted_blocks);
+	console_out_f(_T("Compiled blocks: %u, recompiled: %u\n"),
+		jit_stat_compiles, jit_stat_recompiles);
+	if (jit_stat_samples) {
+		console_out_f(_T("Block lookups at exits: %u, compiled: %u (%.1f%%)\n"),
+			jit_stat_samples, jit_stat_sample_hits, jit_stat_sample_hits * 100.0 / jit_stat_samples);
+		for (int i = 0; i < cache_segments; i++)
+			console_out_f(_T("Segment %d: %s heat %u age %u\n"), i,
+				cache_segment_used[i] ? _T("used") : _T("free"), cache_segment_heat[i], cache_segment_age[i]);
+	}
+	for (int i = 1; i < FUSE_PATTERNS; i++)
+		console_out_f(_T("Fused %s: %u\n"), fuse_names[i], jit_stat_fused[i]);
+	if (syncbase > 0 && vsynctimebase > 0)
+		console_out_f(_T("Longest compile time in one frame: %.2f ms (%.0f%% of frame), deferred blocks: %u\n"),
+			jit_stat_compile_frame_max * 1000.0 / syncbase,
+			jit_stat_compile_frame_max * 100.0 / vsynctimebase, jit_stat_deferred);
+#ifdef JIT_PAGE_PROTECT
+	console_out_f(_T("Page protection: %u faults, %u blocks invalidated, %u checksums skipped\n"),
+		pageprot_faults, pageprot_invalidated, pageprot_kept);
+#endif
+}
 
 /* "Soft flushing" --- instead of actually throwing everything away,
    we simply mark everything as "needs to be checked".
@@ -4533,6 +4991,39 @@ static inline void flush_icache_lazy(int v)
 	if (!active)
 		return;
 
+#ifdef JIT_PAGE_PROTECT
+	if (pageprot_state) {
+		bi=active;
+		while (bi) {
+			bi2=bi->next;
+			if (bi->status==BI_ACTIVE && pageprot_block_clean(bi)) {
+				/* Still write protected, no need to check */
+			} else {
+				uae_u32 cl=cacheline(bi->pc_p);
+				if (bi->status==BI_INVALID ||
+					bi->status==BI_NEED_RECOMP) {
+					if (bi==cache_tags[cl+1].bi)
+						cache_tags[cl].handler=(cpuop_func*)popall_execute_normal;
+					bi->handler_to_use=(cpuop_func*)popall_execute_normal;
+					set_dhtu(bi,bi->direct_pen);
+					bi->status=BI_INVALID;
+				} else {
+					if (bi==cache_tags[cl+1].bi)
+						cache_tags[cl].handler=(cpuop_func*)popall_check_checksum;
+					bi->handler_to_use=(cpuop_func*)popall_check_checksum;
+					set_dhtu(bi,bi->direct_pcc);
+					bi->status=BI_NEED_CHECK;
+				}
+				remove_from_list(bi);
+				add_to_dormant(bi);
+			}
+			bi=bi2;
+		}
+		pageprot_flush();
+		return;
+	}
+#endif
+
 	bi=active;
 	while (bi) {
 		uae_u32 cl=cacheline(bi->pc_p);
@@ -4718,6 +5209,100 @@ static void pop_all_nat(void)
 }
 #endif
 
+/* Data register written by i, single operand instructions keep it in sreg */
+static int fuse_dreg(struct instr *i)
+{
+	if (i->dmode == Dreg)
+		return i->dreg;
+	if (i->dmode == am_unknown && i->smode == Dreg)
+		return i->sreg;
+	return -1;
+}
+
+/* Returns the register TST.x Dn or CMPI.x #0,Dn at pc tests, -1 otherwise */
+static int fuse_test(struct instr *i, uae_u16 *pc, int *cmp0)
+{
+	*cmp0 = 0;
+	if (i->mnemo == i_TST && i->smode == Dreg)
+		return i->sreg;
+	if (i->mnemo != i_CMP || i->smode != imm || i->dmode != Dreg)
+		return -1;
+	if (i->size == sz_byte ? (do_get_mem_word(pc + 1) & 0xff) : do_get_mem_word(pc + 1))
+		return -1;
+	if (i->size == sz_long && do_get_mem_word(pc + 2))
+		return -1;
+	*cmp0 = 1;
+	return i->dreg;
+}
+
+static int fuse_pattern(uae_u16 *pc1, uae_u16 *pc2, uae_u32 live)
+{
+	struct instr *i1 = &table68k[cft_map(DO_GET_OPCODE(pc1))];
+	struct instr *i2 = &table68k[cft_map(DO_GET_OPCODE(pc2))];
+	int reg, cmp0, pattern;
+
+	reg = fuse_test(i2, pc2, &cmp0);
+	if (reg < 0 || fuse_dreg(i1) != reg || i1->size != i2->size)
+		return FUSE_NONE;
+	switch (i1->mnemo)
+	{
+	case i_MOVE:
+		pattern = FUSE_MOVE_TST;
+		break;
+	case i_AND:
+	case i_OR:
+	case i_EOR:
+	case i_NOT:
+		pattern = FUSE_LOGIC_TST;
+		break;
+	case i_EXT:
+		/* EXTB.L is sz_byte in table68k but sets flags from the long result */
+		if (i1->size == sz_byte)
+			return FUSE_NONE;
+		pattern = FUSE_EXT_TST;
+		break;
+	case i_ADD:
+	case i_SUB:
+	case i_NEG:
+		if (live & (FLAG_V | FLAG_C))
+			return FUSE_NONE;
+		pattern = FUSE_ARITH_TST;
+		break;
+	default:
+		return FUSE_NONE;
+	}
+	if (cmp0)
+		pattern += FUSE_MOVE_CMP0 - FUSE_MOVE_TST;
+	return pattern;
+}
+
+/* Bytes of the dropped TST.x Dn or CMPI.x #0,Dn */
+static int fuse_length(int pattern, int size)
+{
+	if (pattern < FUSE_MOVE_CMP0)
+		return 2;
+	return size == sz_long ? 6 : 4;
+}
+
+static bool compile_deferred(void *pc_p)
+{
+	blockinfo *bi;
+
+	if (compile_budget_frame != timeframes) {
+		compile_budget_frame = timeframes;
+		compile_frame_time = 0;
+	}
+	if (!currprefs.comp_deferred || vsynctimebase <= 0 || compile_frame_time < vsynctimebase / 4)
+		return false;
+	/* Existing blocks are still recompiled, interpreting them is slower
+	   than keeping the old translation. */
+	bi = get_blockinfo_addr(pc_p);
+	if (bi && bi->status != BI_INVALID)
+		return false;
+	jit_stat_deferred++;
+	return true;
+}
+
 #if 0
 static void print_inst(void)
 {
@@ -4742,12 +5327,20 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 #ifdef JIT_DEBUG
 		bool disasm_block = false;
 #endif
+		if (compile_deferred(pc_hist[0].location)) {
+#ifdef UAE
+			do_extra_cycles(totcycles);
+#endif
+			return;
+		}
+		frame_time_t compile_start = read_processor_time();
 
 		/* OK, here we need to 'compile' a block */
 		int i;
 		int r;
 		int was_comp=0;
 		uae_u8 liveflags[MAXRUN+1];
+		uae_u8 fused[MAXRUN+1];
 #if USE_CHECKSUM_INFO
 		bool trace_in_rom = isinrom((uintptr)pc_hist[0].location) != 0;
 		uintptr max_pcp=(uintptr)pc_hist[blocklen - 1].location;
@@ -4764,13 +5357,17 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 
 		redo_current_block=0;
 		if (current_compile_p >= MAX_COMPILE_PTR)
-			flush_icache_hard(3);
+			next_cache_segment();
 
 		alloc_blockinfos();
 
 		bi=get_blockinfo_addr_new(pc_hist[0].location,0);
 		bi2=get_blockinfo(cl);
 
+		jit_stat_compiles++;
+		if (bi->status!=BI_INVALID)
+			jit_stat_recompiles++;
+
 		optlev=bi->optlevel;
 		if (bi->status!=BI_INVALID) {
 			Dif (bi!=bi2) {
@@ -4824,6 +5421,15 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 				max_pcp=(uintptr)currpcp;
 #endif
 
+			/* Last instruction is never fused, block end code needs its PC */
+			fused[i] = FUSE_NONE;
+			if (i > 0 && i < blocklen - 1 && optlev > 1)
+				fused[i] = fuse_pattern(pc_hist[i - 1].location, pc_hist[i].location, liveflags[i+1]);
+			if (fused[i]) {
+				liveflags[i] = liveflags[i+1];
+				continue;
+			}
+
 #ifdef UAE
 			if (!currprefs.compnf) {
 				liveflags[i]=FLAG_ALL;
@@ -4899,6 +5505,12 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 				cpuop_func **cputbl;
 				compop_func **comptbl;
 				uae_u32 opcode=DO_GET_OPCODE(pc_hist[i].location);
+				if (fused[i]) {
+					jit_stat_fused[fused[i]]++;
+					if (was_comp)
+						m68k_pc_offset += fuse_length(fused[i], table68k[cft_map(opcode)].size);
+					continue;
+				}
 				needed_flags=(liveflags[i+1] & prop[opcode].set_flags);
 #ifdef UAE
 				special_mem=pc_hist[i].specmem;
@@ -5238,6 +5850,9 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 		else {
 			calc_checksum(bi,&(bi->c1),&(bi->c2));
 			add_to_active(bi);
+#ifdef JIT_PAGE_PROTECT
+			pageprot_block(bi);
+#endif
 		}
 #else
 		if (next_pc_p+extra_len>=max_pcp &&
@@ -5312,7 +5927,7 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 #endif
 
 		/* We will flush soon, anyway, so let's do it now */
-		if (current_compile_p >= MAX_COMPILE_PTR)
+		if (current_compile_p >= MAX_COMPILE_PTR && cache_segments <= 1)
 			flush_icache_hard(3);
 
 		bi->status=BI_ACTIVE;
@@ -5322,6 +5937,9 @@ static void compile_block(cpu_history* pc_hist, int blocklen)
 #ifdef PROFILE_COMPILE_TIME
 		compile_time += (clock() - start_time);
 #endif
+		compile_frame_time += read_processor_time() - compile_start;
+		if (compile_frame_time > jit_stat_compile_frame_max)
+			jit_stat_compile_frame_max = compile_frame_time;
 #ifdef UAE
 		/* Account for compilation time */
 		do_extra_cycles(totcycles);
@@ -18,6 +18,15 @@
 #include "newcpu.h"
 #include "gfxboard.h"
 #include "xwin.h"
+#include "threaddep/thread.h"
+#include "vramwatch.h"
+
+#define TMS_CPU_THREAD 1
+#define TMS_CYCLES_PER_LINE 100
+#define TMS_THREAD_SLICE_LINES 4
+#define TMS_THREAD_BACKLOG_LINES 64
+#define TMS_INLINE_LINES 625
+#define TMS_LINE_RING 128
 
 rectangle tms_rectangle;
 static mscreen tms_screen;
@@ -27,6 +36,20 @@ mscreen *m_screen;
 
 #define OVERLAY_WIDTH 1024
 
+struct tms_line
+{
+	int vpos;
+	tms34010_display_params parms;
+};
+
+struct tms_ext_call
+{
+	int bank, size;
+	bool write;
+	uaecptr addr;
+	uae_u16 v;
+};
+
 struct a2410_struct
 {
 	int tms_vp, tms_hp;
@@ -57,11 +80,30 @@ struct a2410_struct
 	int a2410_vram_start_offset;
 	uae_u8 *a2410_surface;
 	int a2410_interlace;
-	int a2410_interrupt;
+	volatile int a2410_interrupt;
 	int a2410_hsync_max;
 	bool a2410_visible;
 
 	addrbank *gfxbank;
+
+	uae_thread_id cpu_thread;
+	uae_thread_id cpu_thread_id;
+	uae_sem_t cpu_lock;
+	uae_sem_t cpu_wake;
+	volatile bool cpu_thread_running;
+	volatile bool cpu_thread_quit;
+	volatile bool cpu_thread_idle;
+	volatile uae_u32 lines_given, lines_done;
+	volatile bool tms_inline;
+	int inline_lines;
+	struct tms_ext_call *volatile ext_call;
+	uae_sem_t ext_done;
+	volatile uae_u32 line_wr;
+	uae_u32 line_rd;
+	struct tms_line lines[TMS_LINE_RING];
+	volatile uae_thread_id lock_owner;
+	int lock_depth;
+	uae_u32 cpu_slices, cpu_lock_waits, ext_calls, inline_switches;
 };
 
 static struct a2410_struct a2410_data;
@@ -83,10 +125,157 @@ int mscreen::vpos()
 	return a2410_data.tms_vp;
 }
 
-static void tms_execute_single(void)
+/*
+ * With TMS_CPU_THREAD the TMS34010 runs slices of a few scanlines in
+ * its own thread, holding cpu_lock while executing. Each line runs the
+ * CPU and the scanline callback and queues the line's display state,
+ * hsync only hands out lines and draws the queued ones. Host interface
+ * accesses take the same lock so they always see the TMS in between
+ * instructions. Interrupts raised from the TMS thread are passed to
+ * Paula in the next hsync.
+ *
+ * DMA, CONTROL and RAMDAC accesses touch Amiga side state. The TMS
+ * thread hands them to the emulation thread and the TMS then runs
+ * inline from hsync, like without the thread, until it has not used
+ * them for a while and the bus request is released.
+ */
+static bool tms_on_cpu_thread(struct a2410_struct *data)
 {
+	return data->cpu_thread_running && data->cpu_thread_id == uae_thread_get_id();
+}
+
+static void tms_ext_service(struct a2410_struct *data);
+
+static bool tms_lock(struct a2410_struct *data)
+{
+	if (!data->cpu_thread_running || tms_on_cpu_thread(data))
+		return false;
+	uae_thread_id self = uae_thread_get_id();
+	if (data->lock_owner == self) {
+		data->lock_depth++;
+		return true;
+	}
+	if (uae_sem_trywait(&data->cpu_lock)) {
+		data->cpu_lock_waits++;
+		// TMS thread may be waiting for us
+		for (;;) {
+			tms_ext_service(data);
+			if (!uae_sem_trywait_delay(&data->cpu_lock, 1))
+				break;
+		}
+	}
+	data->lock_owner = self;
+	data->lock_depth = 1;
+	return true;
+}
+
+static void tms_unlock(struct a2410_struct *data, bool locked)
+{
+	if (locked && --data->lock_depth == 0) {
+		data->lock_owner = NULL;
+		uae_sem_post(&data->cpu_lock);
+	}
+}
+
+static void tms_execute_single(struct a2410_struct *data)
+{
+	// CPU thread keeps running on its own
+	if (data->cpu_thread_running && !data->tms_inline)
+		return;
+	bool locked = tms_lock(data);
 	tms_device.m_icount = 2;
 	tms_device.execute_run();
+	tms_unlock(data, locked);
+}
+
+static void tms_run_line(struct a2410_struct *data)
+{
+	struct tms_line *l = &data->lines[data->line_wr & (TMS_LINE_RING - 1)];
+
+	tms_device.m_icount = TMS_CYCLES_PER_LINE;
+	tms_device.execute_run();
+	l->vpos = data->tms_vp;
+	data->tms_vp = tms_device.scanline_callback(NULL, data->tms_vp, data->a2410_interlace < 0);
+	tms_device.get_display_params(&l->parms);
+	data->line_wr++;
+}
+
+static void tms_cpu_thread(void *v)
+{
+	struct a2410_struct *data = (struct a2410_struct*)v;
+
+	data->cpu_thread_id = uae_thread_get_id();
+	data->cpu_thread_running = true;
+	while (!data->cpu_thread_quit) {
+		int lines = (int)(data->lines_given - data->lines_done);
+		if (lines <= 0 || data->tms_inline || !data->tms_configured) {
+			data->cpu_thread_idle = true;
+			uae_sem_trywait_delay(&data->cpu_wake, 10);
+			data->cpu_thread_idle = false;
+			continue;
+		}
+		if (lines > TMS_THREAD_SLICE_LINES)
+			lines = TMS_THREAD_SLICE_LINES;
+		int done = 0;
+		uae_sem_wait(&data->cpu_lock);
+		while (done < lines) {
+			if (data->cpu_thread_quit || data->tms_inline || !data->tms_configured)
+				break;
+			tms_run_line(data);
+			done++;
+		}
+		uae_sem_post(&data->cpu_lock);
+		// lines left over from a slice cut short stay in the backlog
+		data->lines_done += done;
+		data->cpu_slices++;
+	}
+	data->cpu_thread_running = false;
+}
+
+static void tms_cpu_thread_start(struct a2410_struct *data)
+{
+	if (!TMS_CPU_THREAD || data->cpu_thread)
+		return;
+	uae_sem_init(&data->cpu_lock, 0, 1);
+	uae_sem_init(&data->cpu_wake, 0, 0);
+	uae_sem_init(&data->ext_done, 0, 0);
+	data->cpu_thread_quit = false;
+	data->lines_given = data->lines_done = 0;
+	data->tms_inline = false;
+	data->ext_call = NULL;
+	data->cpu_slices = data->cpu_lock_waits = data->ext_calls = data->inline_switches = 0;
+	data->lock_owner = NULL;
+	data->lock_depth = 0;
+	if (!uae_start_thread(_T("tms34010"), tms_cpu_thread, data, &data->cpu_thread)) {
+		write_log(_T("TMS34010 CPU thread failed to start\n"));
+		data->cpu_thread = 0;
+		uae_sem_destroy(&data->cpu_lock);
+		uae_sem_destroy(&data->cpu_wake);
+		uae_sem_destroy(&data->ext_done);
+		return;
+	}
+	while (!data->cpu_thread_running)
+		sleep_millis(1);
+}
+
+static void tms_cpu_thread_stop(struct a2410_struct *data)
+{
+	if (!data->cpu_thread)
+		return;
+	data->cpu_thread_quit = true;
+	uae_sem_post(&data->cpu_wake);
+	// thread may be waiting for an Amiga side access
+	while (data->cpu_thread_running) {
+		tms_ext_service(data);
+		sleep_millis(1);
+	}
+	uae_wait_thread(data->cpu_thread);
+	data->cpu_thread = 0;
+	uae_sem_destroy(&data->cpu_lock);
+	uae_sem_destroy(&data->cpu_wake);
+	uae_sem_destroy(&data->ext_done);
+	write_log(_T("TMS34010 CPU thread: %u slices, %u lock waits, %u Amiga side accesses, %u inline switches\n"),
+		data->cpu_slices, data->cpu_lock_waits, data->ext_calls, data->inline_switches);
 }
 
 #define A2410_BANK_FRAMEBUFFER 1
@@ -162,6 +351,7 @@ void m_to_shiftreg_cb(address_space space, offs_t offset, UINT16 *shiftreg)
 void m_from_shiftreg_cb(address_space space, offs_t offset, UINT16* shiftreg)
 {
 	memcpy(&gfxmem_banks[a2410_data.a2410_gfxboard]->baseaddr[TOWORD(offset)], shiftreg, 256 * sizeof(UINT16));
+	vramwatch_mark(a2410_data.a2410_gfxboard, TOWORD(offset), 256 * sizeof(UINT16));
 }
 
 UINT16 direct_read_data::read_decrypted_word(UINT32 pc)
@@ -328,6 +518,84 @@ static bool valid_dma(struct a2410_struct *data, uaecptr addr)
 	return addr < data->tms_configured || addr >= (data->tms_configured + 65536);
 }
 
+// DMA, CONTROL and RAMDAC, emulation thread only
+static uae_u16 tms_ext_access2(struct a2410_struct *data, struct tms_ext_call *c)
+{
+	uaecptr addr = c->addr;
+	uae_u16 v = c->v;
+
+	data->inline_lines = 0;
+	switch (c->bank)
+	{
+		case A2410_BANK_RAMDAC:
+		if (c->write)
+			write_ramdac(data, addr, (uae_u8)v);
+		else
+			v = read_ramdac(data, addr);
+		break;
+		case A2410_BANK_CONTROL:
+		if (c->write)
+			data->a2410_control = v;
+		else
+			v = get_a2410_control(data);
+		break;
+		case A2410_BANK_DMA:
+		if (!valid_dma(data, addr)) {
+			v = 0;
+			break;
+		}
+		if (c->size == 1) {
+			if (data->a2410_control & 4)
+				addr ^= 1;
+			if (c->write)
+				put_byte(addr, (uae_u8)v);
+			else
+				v = get_byte(addr);
+		} else {
+			if (c->write) {
+				if (data->a2410_control & 4)
+					v = (v >> 8) | (v << 8);
+				put_word(addr, v);
+			} else {
+				v = get_word(addr);
+				if (data->a2410_control & 4)
+					v = (v >> 8) | (v << 8);
+			}
+		}
+		break;
+	}
+	return v;
+}
+
+static void tms_ext_service(struct a2410_struct *data)
+{
+	struct tms_ext_call *c = data->ext_call;
+	if (!c)
+		return;
+	c->v = tms_ext_access2(data, c);
+	data->ext_calls++;
+	data->ext_call = NULL;
+	uae_sem_post(&data->ext_done);
+}
+
+static uae_u16 tms_ext_access(struct a2410_struct *data, int bank, int size, bool write, uaecptr addr, uae_u16 v)
+{
+	struct tms_ext_call c = { bank, size, write, addr, v };
+
+	if (!tms_on_cpu_thread(data))
+		return tms_ext_access2(data, &c);
+	// wait for the emulation thread, keep the lock: TMS is in the middle of an instruction
+	if (!data->tms_inline) {
+		data->tms_inline = true;
+		data->inline_switches++;
+	}
+	data->ext_call = &c;
+	uae_sem_wait(&data->ext_done);
+	// end the slice, following accesses are done inline from hsync
+	tms_device.m_icount = 0;
+	return c.v;
+}
+
 UINT8 address_space::read_byte(UINT32 a)
 {
 	struct a2410_struct *data = &a2410_data;
@@ -348,19 +616,15 @@ UINT8 address_space::read_byte(UINT32 a)
 		//write_log(_T("TMS byte read framebuffer %08x (%08x) = %02x PC=%08x\n"), aa, addr, v, M68K_GETPC);
 		break;
 		case A2410_BANK_RAMDAC:
-		v = read_ramdac(data, addr);
+		v = (uae_u8)tms_ext_access(data, bank, 1, false, addr, 0);
 		//write_log(_T("RAMDAC READ %08x = %02x PC=%08x\n"), aa, v, M68K_GETPC);
 		break;
 		case A2410_BANK_CONTROL:
-		v = get_a2410_control(data);
+		v = (uae_u8)tms_ext_access(data, bank, 1, false, addr, 0);
 		write_log(_T("CONTROL READ %08x = %02x PC=%08x\n"), aa, v, M68K_GETPC);
 		break;
 		case A2410_BANK_DMA:
-		if (valid_dma(data, addr)) {
-			if (data->a2410_control & 4)
-				addr ^= 1;
-			v = get_byte(addr);
-		}
+		v = (uae_u8)tms_ext_access(data, bank, 1, false, addr, 0);
 		break;
 		default:
 		write_log(_T("UNKNOWN READ %08x = %02x PC=%08x\n"), aa, v, M68K_GETPC);
@@ -394,19 +658,15 @@ UINT16 address_space::read_word(UINT32 a)
 		//write_log(_T("TMS gfx word read %08x (%08x) = %04x PC=%08x\n"), aa, addr, v, M68K_GETPC);
 		break;
 		case A2410_BANK_RAMDAC:
-		v = read_ramdac(data, addr);
+		v = tms_ext_access(data, bank, 2, false, addr, 0);
 		//write_log(_T("RAMDAC READ %08x = %02x PC=%08x\n"), aa, v, M68K_GETPC);
 		break;
 		case A2410_BANK_CONTROL:
-		v = get_a2410_control(data);
+		v = tms_ext_access(data, bank, 2, false, addr, 0);
 		write_log(_T("CONTROL READ %08x = %02x PC=%08x\n"), aa, v, M68K_GETPC);
 		break;
 		case A2410_BANK_DMA:
-		if (valid_dma(data, addr)) {
-			v = get_word(addr);
-			if (data->a2410_control & 4)
-				v = (v >> 8) | (v << 8);
-		}
+		v = tms_ext_access(data, bank, 2, false, addr, 0);
 		break;
 		default:
 		write_log(_T("UNKNOWN READ %08x = %04x PC=%08x\n"), aa, v, M68K_GETPC);
@@ -432,22 +692,19 @@ void address_space::write_byte(UINT32 a, UINT8 b)
 		break;
 		case A2410_BANK_FRAMEBUFFER:
 		data->gfxbank->baseaddr[addr] = b;
+		vramwatch_mark(data->a2410_gfxboard, addr, 1);
 		//write_log(_T("TMS gfx byte write %08x (%08x) = %02x PC=%08x\n"), aa, addr, b, M68K_GETPC);
 		break;
 		case A2410_BANK_RAMDAC:
 		//write_log(_T("RAMDAC WRITE %08x = %02x PC=%08x\n"), aa, b, M68K_GETPC);
-		write_ramdac(data, addr, b);
+		tms_ext_access(data, bank, 1, true, addr, b);
 		break;
 		case A2410_BANK_CONTROL:
 		write_log(_T("CONTROL WRITE %08x = %02x PC=%08x\n"), aa, b, M68K_GETPC);
-		data->a2410_control = b;
+		tms_ext_access(data, bank, 1, true, addr, b);
 		break;
 		case A2410_BANK_DMA:
-		if (valid_dma(data, addr)) {
-			if (data->a2410_control & 4)
-				addr ^= 1;
-			put_byte(addr, b);
-		}
+		tms_ext_access(data, bank, 1, true, addr, b);
 		break;
 		default:
 		write_log(_T("UNKNOWN WRITE %08x = %02x PC=%08x\n"), aa, b, M68K_GETPC);
@@ -477,22 +734,19 @@ void address_space::write_word(UINT32 a, UINT16 b)
 		case A2410_BANK_FRAMEBUFFER:
 		data->gfxbank->baseaddr[addr] = b >> 8;
 		data->gfxbank->baseaddr[addr + 1] = b & 0xff;
+		vramwatch_mark(data->a2410_gfxboard, addr, 2);
 		//write_log(_T("TMS gfx word write %08x (%08x) = %04x PC=%08x\n"), aa, addr, b, M68K_GETPC);
 		break;
 		case A2410_BANK_RAMDAC:
 		//write_log(_T("RAMDAC WRITE %08x = %04x IDX=%d/%d PC=%08x\n"), aa, b, a2410_palette_index / 4, a2410_palette_index & 3, M68K_GETPC);
-		write_ramdac(data, addr, (uae_u8)b);
+		tms_ext_access(data, bank, 2, true, addr, (uae_u8)b);
 		break;
 		case A2410_BANK_CONTROL:
 		write_log(_T("CONTROL WRITE %08x = %04x PC=%08x\n"), aa, b, M68K_GETPC);
-		data->a2410_control = b;
+		tms_ext_access(data, bank, 2, true, addr, b);
 		break;
 		case A2410_BANK_DMA:
-		if (valid_dma(data, addr)) {
-			if (data->a2410_control & 4)
-				b = (b >> 8) | (b << 8);
-			put_word(addr, b);
-		}
+		tms_ext_access(data, bank, 2, true, addr, b);
 		break;
 		default:
 		write_log(_T("UNKNOWN WRITE %08x = %04x PC=%08x\n"), aa, b, M68K_GETPC);
@@ -505,12 +759,14 @@ static uae_u32 REGPARAM2 tms_bget(uaecptr addr)
 	struct a2410_struct *data = &a2410_data;
 	uae_u32 v = 0xff;
 	addr &= 65535;
+	bool locked = tms_lock(data);
 	uae_u16 vv = tms_device.host_r(tms_space, addr >> 1);
+	tms_unlock(data, locked);
 	if (!(addr & 1))
 		vv >>= 8;
 	v = (uae_u8)vv;
 	//write_log(_T("TMS read %08x = %02x PC=%08x\n"), addr, v & 0xff, M68K_GETPC);
-	tms_execute_single();
+	tms_execute_single(data);
 	return v;
 }
 static uae_u32 REGPARAM2 tms_wget(uaecptr addr)
@@ -518,9 +774,11 @@ static uae_u32 REGPARAM2 tms_wget(uaecptr addr)
 	struct a2410_struct *data = &a2410_data;
 	uae_u16 v;
 	addr &= 65535;
+	bool locked = tms_lock(data);
 	v = tms_device.host_r(tms_space, addr >> 1);
+	tms_unlock(data, locked);
 	//write_log(_T("TMS read %08x = %04x PC=%08x\n"), addr, v & 0xffff, M68K_GETPC);
-	tms_execute_single();
+	tms_execute_single(data);
 	return v;
 }
 static uae_u32 REGPARAM2 tms_lget(uaecptr addr)
@@ -538,8 +796,10 @@ static void REGPARAM2 tms_wput(uaecptr addr, uae_u32 w)
 	struct a2410_struct *data = &a2410_data;
 	addr &= 65535;
 	//write_log(_T("TMS write %08x = %04x PC=%08x\n"), addr, w & 0xffff, M68K_GETPC);
+	bool locked = tms_lock(data);
 	tms_device.host_w(tms_space, addr  >> 1, w);
-	tms_execute_single();
+	tms_unlock(data, locked);
+	tms_execute_single(data);
 }
 
 static void REGPARAM2 tms_lput(uaecptr addr, uae_u32 l)
@@ -555,8 +815,10 @@ static void REGPARAM2 tms_bput(uaecptr addr, uae_u32 b)
 	b &= 0xff;
 	addr &= 65535;
 	//write_log(_T("tms_bput %08x=%02x PC=%08x\n"), addr, b, M68K_GETPC);
+	bool locked = tms_lock(data);
 	tms_device.host_w(tms_space, addr >> 1, (b << 8) | b);
-	tms_execute_single();
+	tms_unlock(data, locked);
+	tms_execute_single(data);
 }
 
 static addrbank tms_bank = {
@@ -584,9 +846,11 @@ static void tms_reset(void *userdata)
 	data->a2410_visible = false;
 	data->a2410_enabled = false;
 
+	bool locked = tms_lock(data);
 	if (data->program_ram)
 		tms_device.device_reset();
 	data->tms_configured = 0;
+	tms_unlock(data, locked);
 }
 
 static void tms_configured(void *userdata, uae_u32 address)
@@ -600,6 +864,8 @@ static void tms_free(void *userdata)
 	struct a2410_struct *data = (struct a2410_struct*)userdata;
 	int monid = currprefs.rtgboards[data->a2410_gfxboard].monitor_id;
 
+	tms_cpu_thread_stop(data);
+
 	if (data->a2410_surface)
 		gfx_unlock_picasso(monid, true);
 	data->a2410_surface = NULL;
@@ -644,6 +910,7 @@ static bool tms_init(struct autoconfig_info *aci)
 	m_screen = &tms_screen;
 	tms_device.device_start();
 	tms_reset(data);
+	tms_cpu_thread_start(data);
 
 	aci->userdata = data; 
 	return true;
@@ -708,7 +975,7 @@ static bool tms_toggle(void *userdata, int mode)
 	return false;
 }
 
-static void tms_vsync_handler2(struct a2410_struct *data, bool internalsync)
+static void tms_vsync_handler2(struct a2410_struct *data, bool internalsync, tms34010_display_params *lineparms)
 {
 	int monid = currprefs.rtgboards[data->a2410_gfxboard].monitor_id;
 	struct amigadisplay *ad = &adisplays[monid];
@@ -717,7 +984,13 @@ static void tms_vsync_handler2(struct a2410_struct *data, bool internalsync)
 		return;
 
 	tms34010_display_params parms;
-	tms_device.get_display_params(&parms);
+	if (lineparms) {
+		parms = *lineparms;
+	} else {
+		bool locked = tms_lock(data);
+		tms_device.get_display_params(&parms);
+		tms_unlock(data, locked);
+	}
 	bool enabled = parms.enabled != 0 && data->a2410_gotmode > 0;
 
 	if (!data->a2410_visible && data->a2410_modechanged) {
@@ -782,7 +1055,7 @@ static bool tms_vsync(void *userdata, struct gfxboard_mode *mode)
 
 	bool flushed = false;
 	if (!data->a2410_enabled)
-		tms_vsync_handler2(data, false);
+		tms_vsync_handler2(data, false, NULL);
 
 	data->a2410_surface = NULL;
 	gfx_unlock_picasso(monid, true);
@@ -798,28 +1071,20 @@ static bool tms_vsync(void *userdata, struct gfxboard_mode *mode)
 	return flushed;
 }
 
-static void tms_hsync_handler2(struct a2410_struct *data)
+static void tms_draw_line(struct a2410_struct *data, int a2410_vpos, tms34010_display_params *lineparms)
 {
 	int monid = currprefs.rtgboards[data->a2410_gfxboard].monitor_id;
 	struct picasso_vidbuf_description *vidinfo = &picasso_vidinfo[monid];
 	struct amigadisplay *ad = &adisplays[monid];
-
-	if (!data->tms_configured)
-		return;
-
-	tms_device.m_icount = 100;
-	tms_device.execute_run();
-	int a2410_vpos = data->tms_vp;
-	data->tms_vp = tms_device.scanline_callback(NULL, data->tms_vp, data->a2410_interlace < 0);
-
-	a2410_rethink(data);
+	tms34010_display_params &parms = *lineparms;
 
 	if (!data->a2410_enabled)
 		return;
 
 	if (a2410_vpos == 0) {
-		tms_vsync_handler2(data, true);
-		picasso_getwritewatch(data->a2410_gfxboard, data->a2410_vram_start_offset, NULL, NULL);
+		tms_vsync_handler2(data, true, lineparms);
+		if (picasso_getwritewatch(data->a2410_gfxboard, data->a2410_vram_start_offset, NULL, NULL) < 0 && !data->fullrefresh)
+			data->fullrefresh = 2;
 	}
 
 	if (data->a2410_modechanged || !ad->picasso_on)
@@ -829,9 +1094,6 @@ static void tms_hsync_handler2(struct a2410_struct *data)
 		data->fullrefresh--;
 	}
 
-	tms34010_display_params parms;
-	tms_device.get_display_params(&parms);
-
 	data->a2410_displaywidth = parms.hsblnk - parms.heblnk;
 	data->a2410_displayend = parms.heblnk;
 	data->a2410_vertical_start = parms.veblnk;
@@ -953,6 +1215,40 @@ static void tms_hsync_handler2(struct a2410_struct *data)
 
 }
 
+static void tms_hsync_handler2(struct a2410_struct *data)
+{
+	if (!data->tms_configured)
+		return;
+
+	if (!data->cpu_thread_running) {
+		tms_run_line(data);
+	} else {
+		tms_ext_service(data);
+		if (data->tms_inline) {
+			// waits for the end of the thread's slice only when switching
+			bool locked = tms_lock(data);
+			tms_run_line(data);
+			tms_unlock(data, locked);
+			if (++data->inline_lines >= TMS_INLINE_LINES && !(data->a2410_control & 8))
+				data->tms_inline = false;
+		} else {
+			int backlog = (int)(data->lines_given - data->lines_done);
+			if (backlog < TMS_THREAD_BACKLOG_LINES)
+				data->lines_given++;
+			if (data->cpu_thread_idle)
+				uae_sem_post(&data->cpu_wake);
+		}
+	}
+
+	a2410_rethink(data);
+
+	while (data->line_rd != data->line_wr) {
+		struct tms_line *l = &data->lines[data->line_rd & (TMS_LINE_RING - 1)];
+		tms_draw_line(data, l->vpos, &l->parms);
+		data->line_rd++;
+	}
+}
+
 static void tms_hsync(void *userdata)
 {
 	struct a2410_struct *data = (struct a2410_struct*)userdata;
@@ -966,7 +1262,9 @@ void standard_irq_callback(int level)
 	struct a2410_struct *data = &a2410_data;
 
 	data->a2410_interrupt = level;
-	a2410_rethink(data);
+	// TMS thread: picked up by a2410_rethink() in next hsync
+	if (!tms_on_cpu_thread(data))
+		a2410_rethink(data);
 }
 
 struct gfxboard_func a2410_func
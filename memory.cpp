@@ -3251,6 +3251,7 @@ static void map_banks2 (addrbank *bank, int start, int size, int realsize, int q
 
 	if (quick <= 0)
 		old = debug_bankchange (-1);
+	compemu_unprotect(0, 0xffffffff);
 	flush_icache(3); /* Sure don't want to keep any old mappings around! */
 #ifdef NATMEM_OFFSET
 	if (!quick)
@@ -5308,6 +5308,7 @@ static void cpu_thread_run_jit(void *v)
 	{
 		for (;;) {
 			((compiled_handler*)(pushall_call_handler))();
+			compemu_sample();
 			/* Whenever we return from that, we should check spcflags */
 			if (regs.spcflags || cpu_thread_ilvl > 0) {
 				if (do_specialties_thread()) {
@@ -5345,6 +5346,7 @@ static void m68k_run_jit(void)
 #endif
 			for (;;) {
 				((compiled_handler*)(pushall_call_handler))();
+				compemu_sample();
 				/* Whenever we return from that, we should check spcflags */
 				check_uae_int_request();
 				if (regs.spcflags) {
@@ -6177,11 +6179,13 @@ static void m68k_run_2_020(void)
 
 	while (!exit) {
 		check_debugger();
+		// table mode can only change via SPCFLAG_MODE_CHANGE which exits this loop
+		bool direct = m68k_pc_indirect == 0;
 		TRY(prb) {
 			while (!exit) {
 				r->instruction_pc = m68k_getpc();
 
-				r->opcode = x_get_iword(0);
+				r->opcode = direct ? get_diword(0) : x_get_iword(0);
 				count_instr(r->opcode);
 
 				if (debug_opcode_watch) {
@@ -6190,7 +6194,11 @@ static void m68k_run_2_020(void)
 
 				cpu_cycles = (*cpufunctbl[r->opcode])(r->opcode) >> 16;
 				cpu_cycles = adjust_cycles(cpu_cycles);
-				do_cycles(cpu_cycles);
+				// inline do_cycles() fast path, call it only when events are due
+				if ((pissoff -= cpu_cycles) < 0 || currprefs.cpu_thread) {
+					pissoff += cpu_cycles;
+					do_cycles(cpu_cycles);
+				}
 
 				if (r->spcflags) {
 					if (do_specialties(cpu_cycles))
@@ -9,6 +9,8 @@
 * GNU Public License
 *
 */
+// WaitSelect() sockets of all tasks share one select() set
+#define FD_SETSIZE 1024
 #include <winsock2.h>
 #include <Ws2tcpip.h>
 
@@ -55,18 +57,35 @@ struct threadargs {
 	int wscnt;
 };
 
-struct threadargsw {
+// Pending WaitSelect() call, serviced by the select reactor thread.
+struct selectreq {
 	struct socketbase *sb;
-	uae_u32 nfds;
-	uae_u32 readfds;
-	uae_u32 writefds;
-	uae_u32 exceptfds;
-	uae_u32 timeout;
+	struct fd_set readsocks;
+	struct fd_set writesocks;
+	struct fd_set exceptsocks;
+	int hastimeout;
+	ULONGLONG deadline;
+	int resultval;
+	int err;
+	volatile int cancel;
+	volatile int done;
 	int wscnt;
+	struct selectreq *next;
 };
 
-#define MAX_SELECT_THREADS 64
 #define MAX_GET_THREADS 64
+#define REACTOR_SETSIZE 4096
+#define REACTOR_HASHSIZE (REACTOR_SETSIZE * 2)
+
+// fd_set compatible header, followed by an open addressing index of
+// fd_array. Index slots are only valid if tagged with the current gen.
+struct reactor_fdset {
+	u_int fd_count;
+	SOCKET fd_array[REACTOR_SETSIZE];
+	SOCKET hash[REACTOR_HASHSIZE];
+	uae_u32 hashgen[REACTOR_HASHSIZE];
+	uae_u32 gen;
+};
 
 struct bsdsockdata {
 	HWND hSockWnd;
@@ -84,9 +103,13 @@ struct bsdsockdata {
 	volatile HANDLE hGetEvents[MAX_GET_THREADS];
 	volatile HANDLE hGetEvents2[MAX_GET_THREADS];
 
-	volatile HANDLE hThreads[MAX_SELECT_THREADS];
-	volatile struct threadargsw *threadargsw[MAX_SELECT_THREADS];
-	volatile HANDLE hEvents[MAX_SELECT_THREADS];
+	HANDLE hReactorThread;
+	CRITICAL_SECTION csReactor;
+	SOCKET reactorWake;
+	volatile int reactorActive;
+	struct selectreq *selectreqs;
+	struct reactor_fdset reactorRead, reactorWrite, reactorExcept;
+	uae_u32 reactorPolls, reactorCompleted, reactorCancelled, reactorDirect;
 
 	struct socketbase *asyncsb[MAXPENDINGASYNC];
 	SOCKET asyncsock[MAXPENDINGASYNC];
@@ -247,21 +270,33 @@ int init_socket_layer (void)
 	return result;
 }
 
+static void reactor_wake(void)
+{
+	char c = 0;
+	send(bsd->reactorWake, &c, 1, 0);
+}
+
+static void close_reactor(void)
+{
+	if (!bsd->hReactorThread)
+		return;
+	bsd->reactorActive = 0;
+	reactor_wake();
+	WaitForSingleObject(bsd->hReactorThread, INFINITE);
+	CloseHandle(bsd->hReactorThread);
+	bsd->hReactorThread = NULL;
+	closesocket(bsd->reactorWake);
+	bsd->reactorWake = INVALID_SOCKET;
+	DeleteCriticalSection(&bsd->csReactor);
+	write_log(_T("BSDSOCK: select reactor: %u polls, %u completed, %u cancelled, %u direct\n"),
+		bsd->reactorPolls, bsd->reactorCompleted, bsd->reactorCancelled, bsd->reactorDirect);
+}
+
 static void close_selectget_threads(void)
 {
 	int i;
 
-	for (i = 0; i < MAX_SELECT_THREADS; i++) {
-		if (bsd->hEvents[i]) {
-			HANDLE h = bsd->hEvents[i];
-			bsd->hEvents[i] = NULL;
-			CloseHandle (h);
-		}
-		if (bsd->hThreads[i]) {
-			CloseHandle (bsd->hThreads[i]);
-			bsd->hThreads[i] = NULL;
-		}
-	}
+	close_reactor();
 
 	for (i = 0; i < MAX_GET_THREADS; i++) {
 		if (bsd->hGetThreads[i]) {
@@ -338,10 +373,6 @@ void unlocksigqueue(void)
 
 int host_sbinit(TrapContext *context, SB)
 {
-	sb->sockAbort = socket(AF_INET,SOCK_STREAM,IPPROTO_TCP);
-
-	if (sb->sockAbort == INVALID_SOCKET)
-		return 0;
 	if ((sb->hEvent = CreateEvent(NULL,FALSE,FALSE,NULL)) == NULL)
 		return 0;
 
@@ -389,12 +420,6 @@ void host_sbcleanup(SB)
 			bsd->asyncsb[(sb->mtable[i] - 0xb000) / 2] = NULL;
 	}
 
-	if (sb->sockAbort != INVALID_SOCKET) {
-		shutdown(sb->sockAbort, 1);
-		closesocket(sb->sockAbort);
-		sb->sockAbort = INVALID_SOCKET;
-	}
-
 	free(sb->mtable);
 	sb->mtable = NULL;
 }
@@ -407,9 +432,6 @@ void host_sbreset(void)
 		bsd->asyncsock[i] = 0;
 		bsd->asyncsd[i] = 0;
 	}
-	for (i = 0; i < MAX_GET_THREADS; i++) {
-		bsd->threadargsw[i] = 0;
-	}
 }
 
 static void sockmsg(unsigned int msg, WPARAM wParam, LPARAM lParam)
@@ -737,6 +759,7 @@ void host_accept(TrapContext *ctx, SB, uae_u32 sd, uae_u32 name, uae_u32 namelen
 			return;
 		rp_nameuae = rp_name = (struct sockaddr *)get_real_address (name);
 		hlenuae = hlen = trap_get_long(ctx, namelen);
+		compemu_unprotect(name, hlenuae);
 		if (hlenuae < sizeof(sockaddr))
 		{ // Fix for CNET BBS Windows must have 16 Bytes (sizeof(sockaddr)) otherwise Error WSAEFAULT
 			rp_name = &sockaddr;
@@ -827,9 +850,6 @@ typedef enum
 	connect_req,
 	recvfrom_req,
 	sendto_req,
-#if 0
-	abort_req,
-#endif
 	last_req
 } threadsock_e;
 
@@ -862,10 +882,6 @@ struct threadsock_packet
 			uae_char *buf;
 			uae_u32 namelen;
 		} connect_s;
-		struct abort_params
-		{
-			SOCKET *newsock;
-		} abort_s;
 	} params;
 	SOCKET s;
 	SB;
@@ -921,17 +937,6 @@ static BOOL HandleStuff(void)
 					}
 				}
 				break;
-#if 0 /* unused */
-			case abort_req:
-				*(sockreq.params.abort_s.newsock) = socket(AF_INET,SOCK_STREAM,IPPROTO_TCP);
-				if (*(sockreq.params.abort_s.newsock) != sb->sockAbort) {
-					shutdown(sb->sockAbort, 1);
-					closesocket(sb->sockAbort);
-					sb->sockAbort = INVALID_SOCKET;
-				}
-				handled = FALSE; /* Don't bother the SETERRNO section after the switch() */
-				break;
-#endif
 			case last_req:
 			default:
 				write_log (_T("BSDSOCK: Invalid sock-thread request!\n"));
@@ -1317,6 +1322,7 @@ void host_recvfrom(TrapContext *ctx, SB, uae_u32 sd, uae_u32 msg, uae_u8 *hmsg,
 			if (!addr_valid (_T("host_recvfrom1"), msg, 4))
 				return;
 			realpt = (char*)get_real_address (msg);
+			compemu_unprotect(msg, len);
 		} else {
 			realpt = (char*)hmsg;
 		}
@@ -1328,6 +1334,7 @@ void host_recvfrom(TrapContext *ctx, SB, uae_u32 sd, uae_u32 msg, uae_u8 *hmsg,
 			if (!addr_valid (_T("host_recvfrom2"), addr, hlen))
 				return;
 			rp_addr = (struct sockaddr *)get_real_address (addr);
+			compemu_unprotect(addr, hlen);
 		}
 
 		BEGINBLOCKING;
@@ -1599,6 +1606,7 @@ uae_u32 host_getsockname(TrapContext *ctx, SB, uae_u32 sd, uae_u32 name, uae_u32
 		if (!trap_valid_address(ctx, name, len))
 			return -1;
 		rp_name = (struct sockaddr *)get_real_address (name);
+		compemu_unprotect(name, len);
 
 		if (getsockname(s,rp_name,&len)) {
 			SETERRNO;
@@ -1633,6 +1641,7 @@ uae_u32 host_getpeername(TrapContext *ctx, SB, uae_u32 sd, uae_u32 name, uae_u32
 		if (!trap_valid_address(ctx, name, len))
 			return -1;
 		rp_name = (struct sockaddr *)get_real_address (name);
+		compemu_unprotect(name, len);
 
 		if (getpeername(s,rp_name,&len)) {
 			SETERRNO;
@@ -2059,136 +2068,251 @@ static void fd_zero(TrapContext *ctx, uae_u32 fdset, uae_u32 nfds)
 		trap_put_long(ctx, fdset,0);
 }
 
-// This seems to be the only way of implementing a cancelable WinSock2 select() call... sigh.
-static unsigned int thread_WaitSelect2(void *indexp)
+static void reactor_clearhash(struct reactor_fdset *rs)
 {
-	int index = *((int*)indexp);
-	unsigned int result = 0, resultval;
-	int wscnt;
-	long nfds;
-	uae_u32 readfds, writefds, exceptfds;
-	uae_u32 timeout;
-	struct fd_set readsocks, writesocks, exceptsocks;
-	struct timeval tv;
-	volatile struct threadargsw *args;
-	TrapContext *ctx = NULL;
-
-	SB;
-
-	while (bsd->hEvents[index]) {
-		if (WaitForSingleObject(bsd->hEvents[index], INFINITE) == WAIT_ABANDONED)
-			break;
-		if (bsd->hEvents[index] == NULL)
-			break;
+	if (++rs->gen == 0) {
+		memset(rs->hashgen, 0, sizeof rs->hashgen);
+		rs->gen = 1;
+	}
+}
 
-		if ((args = bsd->threadargsw[index]) != NULL) {
-			sb = args->sb;
-			nfds = args->nfds;
-			readfds = args->readfds;
-			writefds = args->writefds;
-			exceptfds = args->exceptfds;
-			timeout = args->timeout;
-			wscnt = args->wscnt;
+// returns true if s was already indexed, adds it otherwise
+static bool reactor_hash(struct reactor_fdset *rs, SOCKET s, bool add)
+{
+	u_int h = ((u_int)(s >> 2) * 2654435761u) & (REACTOR_HASHSIZE - 1);
+	while (rs->hashgen[h] == rs->gen) {
+		if (rs->hash[h] == s)
+			return true;
+		h = (h + 1) & (REACTOR_HASHSIZE - 1);
+	}
+	if (add) {
+		rs->hashgen[h] = rs->gen;
+		rs->hash[h] = s;
+	}
+	return false;
+}
 
-			// construct descriptor tables
-			makesocktable(ctx, sb, readfds, &readsocks, nfds, sb->sockAbort, _T("R"));
-			if (writefds)
-				makesocktable(ctx, sb, writefds, &writesocks, nfds, INVALID_SOCKET, _T("W"));
-			if (exceptfds)
-				makesocktable(ctx, sb, exceptfds, &exceptsocks, nfds, INVALID_SOCKET, _T("E"));
+static void reactor_resetset(struct reactor_fdset *rs)
+{
+	rs->fd_count = 0;
+	reactor_clearhash(rs);
+}
 
-			if (timeout) {
-				tv.tv_sec = get_long (timeout);
-				tv.tv_usec = get_long (timeout+4);
-				BSDTRACE((_T("(to: %d.%06d) "),tv.tv_sec,tv.tv_usec));
-			}
+static void reactor_addsock(struct reactor_fdset *rs, SOCKET s)
+{
+	if (rs->fd_count < REACTOR_SETSIZE && !reactor_hash(rs, s, true))
+		rs->fd_array[rs->fd_count++] = s;
+}
 
-			BSDTRACE((_T("tWS2(%d) -> "), wscnt));
+static void reactor_addset(struct reactor_fdset *rs, struct fd_set *set)
+{
+	for (u_int i = 0; i < set->fd_count; i++)
+		reactor_addsock(rs, set->fd_array[i]);
+}
 
-			resultval = select(nfds+1,
-				readsocks.fd_count > 0 ? &readsocks : NULL,
-				writefds && writesocks.fd_count > 0 ? &writesocks : NULL,
-				exceptfds && exceptsocks.fd_count > 0 ? &exceptsocks : NULL,
-				timeout ? &tv : NULL);
-			if (bsd->hEvents[index] == NULL)
-				break;
+// select() leaves only the ready sockets in fd_array, index them
+static void reactor_rehash(struct reactor_fdset *rs)
+{
+	reactor_clearhash(rs);
+	for (u_int i = 0; i < rs->fd_count; i++)
+		reactor_hash(rs, rs->fd_array[i], true);
+}
 
-			BSDTRACE((_T("tWS2(%d,%d) -> "), resultval, wscnt));
-			if (resultval == 0) {
-				BSDTRACE((_T("timeout -> ")));
-			}
+static void reactor_copyset(struct fd_set *dst, const struct fd_set *src)
+{
+	dst->fd_count = src->fd_count;
+	memcpy(dst->fd_array, src->fd_array, src->fd_count * sizeof(SOCKET));
+}
 
-			sb->resultval = resultval;
-			if (sb->resultval == SOCKET_ERROR) {
-				// select was stopped by sb->sockAbort
-				if (readsocks.fd_count > 1) {
-					makesocktable(ctx, sb, readfds, &readsocks, nfds, INVALID_SOCKET, _T("R2"));
-					tv.tv_sec = 0;
-					tv.tv_usec = 10000;
-					// Check for 10ms if data is available
-					resultval = select(nfds+1, &readsocks, writefds ? &writesocks : NULL,exceptfds ? &exceptsocks : NULL,&tv);
-					if (bsd->hEvents[index] == NULL)
-						break;
-					sb->resultval = resultval;
+// copy sockets of set that select() reported ready to out, returns count
+static int reactor_ready(struct fd_set *out, const struct fd_set *set, struct reactor_fdset *rs)
+{
+	u_int cnt = 0;
+	for (u_int i = 0; i < set->fd_count; i++) {
+		if (reactor_hash(rs, set->fd_array[i], false))
+			out->fd_array[cnt++] = set->fd_array[i];
+	}
+	out->fd_count = cnt;
+	return cnt;
+}
 
-#if 0				/* what was this doing here? */
-					if (sb->resultval == 0) { // Now timeout -> really no data available
-						if (GetLastError() != 0) {
-							sb->resultval = SOCKET_ERROR;
-							// Set old resultval
-						}
-					}
-#endif
+static void reactor_complete(struct selectreq *req)
+{
+	struct socketbase *sb = req->sb;
+	req->done = 1;
+	if (req->cancel)
+		bsd->reactorCancelled++;
+	else
+		bsd->reactorCompleted++;
+	SETSIGNAL;
+	SetEvent(sb->hEvent);
+}
 
-				}
+// One thread select()s the sockets of every pending WaitSelect() and
+// completes the calls whose sockets became ready or whose timeout
+// expired. The wake socket interrupts it when the request list changes.
+static unsigned int thread_reactor2(void *p)
+{
+	static struct fd_set rs, ws, es;
+	struct timeval tv;
+	char buf[64];
+
+	while (bsd->reactorActive) {
+		struct reactor_fdset *rr = &bsd->reactorRead;
+		struct reactor_fdset *rw = &bsd->reactorWrite;
+		struct reactor_fdset *re = &bsd->reactorExcept;
+		struct selectreq *req, **prevp;
+		ULONGLONG now = GetTickCount64();
+		int wait = -1;
+		int resultval;
+
+		reactor_resetset(rr);
+		reactor_resetset(rw);
+		reactor_resetset(re);
+		reactor_addsock(rr, bsd->reactorWake);
+
+		EnterCriticalSection(&bsd->csReactor);
+		for (req = bsd->selectreqs; req; req = req->next) {
+			reactor_addset(rr, &req->readsocks);
+			reactor_addset(rw, &req->writesocks);
+			reactor_addset(re, &req->exceptsocks);
+			if (req->hastimeout) {
+				ULONGLONG left64 = req->deadline > now ? req->deadline - now : 0;
+				int left = left64 > 0x7fffffff ? 0x7fffffff : (int)left64;
+				if (wait < 0 || left < wait)
+					wait = left;
 			}
-			if (FD_ISSET(sb->sockAbort,&readsocks)) {
-				BSDTRACE((_T("tWS2 abort %d:%d\n"), sb->resultval, wscnt));
-				if (sb->resultval != SOCKET_ERROR) {
-					sb->resultval--;
-				}
-			} else {
-				sb->needAbort = 0;
+		}
+		LeaveCriticalSection(&bsd->csReactor);
+
+		if (wait >= 0) {
+			tv.tv_sec = wait / 1000;
+			tv.tv_usec = (wait % 1000) * 1000;
+		}
+		resultval = select(0, (struct fd_set*)rr,
+			rw->fd_count ? (struct fd_set*)rw : NULL,
+			re->fd_count ? (struct fd_set*)re : NULL,
+			wait >= 0 ? &tv : NULL);
+		if (!bsd->reactorActive)
+			break;
+		bsd->reactorPolls++;
+
+		if (resultval > 0) {
+			reactor_rehash(rr);
+			reactor_rehash(rw);
+			reactor_rehash(re);
+			if (reactor_hash(rr, bsd->reactorWake, false))
+				while (recv(bsd->reactorWake, buf, sizeof buf, 0) > 0);
+		}
+
+		now = GetTickCount64();
+		EnterCriticalSection(&bsd->csReactor);
+		prevp = &bsd->selectreqs;
+		while ((req = *prevp) != NULL) {
+			// request keeps its sets until it completes
+			int ready = 0;
+			rs.fd_count = ws.fd_count = es.fd_count = 0;
+			if (resultval == SOCKET_ERROR) {
+				// one of the sockets went bad, find out whose
+				struct timeval tv0 = { 0, 0 };
+				reactor_copyset(&rs, &req->readsocks);
+				reactor_copyset(&ws, &req->writesocks);
+				reactor_copyset(&es, &req->exceptsocks);
+				ready = select(0,
+					rs.fd_count ? &rs : NULL,
+					ws.fd_count ? &ws : NULL,
+					es.fd_count ? &es : NULL,
+					&tv0);
+				if (ready == SOCKET_ERROR)
+					req->err = WSAGetLastError();
+			} else if (resultval > 0) {
+				ready = reactor_ready(&rs, &req->readsocks, rr);
+				ready += reactor_ready(&ws, &req->writesocks, rw);
+				ready += reactor_ready(&es, &req->exceptsocks, re);
 			}
-			if (sb->resultval == SOCKET_ERROR) {
-				SETERRNO;
-				BSDTRACE((_T("tWS2 failed %d:%d - "),sb->sb_errno,wscnt));
-				if (readfds)
-					fd_zero(ctx, readfds,nfds);
-				if (writefds)
-					fd_zero(ctx, writefds,nfds);
-				if (exceptfds)
-					fd_zero(ctx, exceptfds,nfds);
+			if (ready || req->cancel || (req->hastimeout && now >= req->deadline)) {
+				if (ready <= 0)
+					rs.fd_count = ws.fd_count = es.fd_count = 0;
+				req->resultval = ready;
+				reactor_copyset(&req->readsocks, &rs);
+				reactor_copyset(&req->writesocks, &ws);
+				reactor_copyset(&req->exceptsocks, &es);
+				*prevp = req->next;
+				reactor_complete(req);
 			} else {
-				BSDTRACE((_T("tWS2 ok %d\n"), wscnt));
-				if (readfds)
-					makesockbitfield(ctx, sb,readfds,&readsocks,nfds);
-				if (writefds)
-					makesockbitfield(ctx, sb,writefds,&writesocks,nfds);
-				if (exceptfds)
-					makesockbitfield(ctx, sb,exceptfds,&exceptsocks,nfds);
+				prevp = &req->next;
 			}
-
-			SETSIGNAL;
-
-			bsd->threadargsw[index] = NULL;
-			SetEvent(sb->hEvent);
 		}
+		LeaveCriticalSection(&bsd->csReactor);
 	}
-	write_log (_T("BSDSOCK: thread_WaitSelect2 terminated\n"));
-	THREADEND(result);
-	return result;
+
+	// complete anything still pending
+	EnterCriticalSection(&bsd->csReactor);
+	while (bsd->selectreqs) {
+		struct selectreq *req = bsd->selectreqs;
+		bsd->selectreqs = req->next;
+		req->readsocks.fd_count = 0;
+		req->writesocks.fd_count = 0;
+		req->exceptsocks.fd_count = 0;
+		req->resultval = 0;
+		req->cancel = 1;
+		reactor_complete(req);
+	}
+	LeaveCriticalSection(&bsd->csReactor);
+
+	write_log (_T("BSDSOCK: select reactor terminated\n"));
+	THREADEND(0);
+	return 0;
 }
 
-static unsigned int __stdcall thread_WaitSelect(void *p)
+static unsigned int __stdcall thread_reactor(void *p)
 {
 	__try {
-		return thread_WaitSelect2 (p);
+		return thread_reactor2 (p);
 	} __except(WIN32_ExceptionFilter(GetExceptionInformation(), GetExceptionCode())) {
 	}
 	return 0;
 }
 
+static int start_reactor(void)
+{
+	SOCKADDR_IN addr;
+	int addrlen = sizeof addr;
+	u_long nonblocking = 1;
+
+	if (bsd->hReactorThread)
+		return 1;
+	bsd->reactorWake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (bsd->reactorWake == INVALID_SOCKET)
+		goto err;
+	memset(&addr, 0, sizeof addr);
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(bsd->reactorWake, (struct sockaddr*)&addr, sizeof addr) == SOCKET_ERROR ||
+		getsockname(bsd->reactorWake, (struct sockaddr*)&addr, &addrlen) == SOCKET_ERROR ||
+		connect(bsd->reactorWake, (struct sockaddr*)&addr, sizeof addr) == SOCKET_ERROR) {
+		closesocket(bsd->reactorWake);
+		goto err;
+	}
+	ioctlsocket(bsd->reactorWake, FIONBIO, &nonblocking);
+	InitializeCriticalSection(&bsd->csReactor);
+	bsd->reactorActive = 1;
+	bsd->hReactorThread = THREAD(thread_reactor, NULL);
+	if (!bsd->hReactorThread) {
+		bsd->reactorActive = 0;
+		closesocket(bsd->reactorWake);
+		DeleteCriticalSection(&bsd->csReactor);
+		goto err;
+	}
+	// this should improve responsiveness
+	SetThreadPriority(bsd->hReactorThread, THREAD_PRIORITY_ABOVE_NORMAL);
+	return 1;
+err:
+	bsd->reactorWake = INVALID_SOCKET;
+	write_log (_T("BSDSOCK: ERROR - select reactor creation failed - error code: %d\n"), WSAGetLastError());
+	return 0;
+}
+
 static void fddebug(const TCHAR *name, uae_u32 nfds, uae_u32 fd)
 {
 	if (!ISBSDTRACE)
@@ -2210,8 +2334,8 @@ void host_WaitSelect(TrapContext *ctx, SB, uae_u32 nfds, uae_u32 readfds, uae_u3
 {
 	static int wscount;
 	uae_u32 sigs, wssigs;
-	int i;
-	struct threadargsw taw;
+	struct selectreq req;
+	struct timeval tv;
 	int wscnt;
 
 	wscnt = ++wscount;
@@ -2267,109 +2391,111 @@ void host_WaitSelect(TrapContext *ctx, SB, uae_u32 nfds, uae_u32 readfds, uae_u3
 		return;
 	}
 
-	ResetEvent(sb->hEvent);
-
-	sb->needAbort = 1;
-
-	locksigqueue ();
-
-	for (i = 0; i < MAX_SELECT_THREADS; i++) {
-		if (bsd->hThreads[i] && !bsd->threadargsw[i])
-			break;
-	}
-
-	if (i >= MAX_SELECT_THREADS) {
-		for (i = 0; i < MAX_SELECT_THREADS; i++) {
-			if (!bsd->hThreads[i]) {
-				bsd->hEvents[i] = CreateEvent(NULL,FALSE,FALSE,NULL);
-				bsd->hThreads[i] = THREAD(thread_WaitSelect, &threadindextable[i]);
-				if (bsd->hEvents[i] == NULL || bsd->hThreads[i] == NULL) {
-					bsd->hThreads[i] = 0;
-					unlocksigqueue ();
-					write_log (_T("BSDSOCK: ERROR - Thread/Event creation failed - error code: %d\n"),
-						GetLastError());
-					bsdsocklib_seterrno(ctx, sb,12); // ENOMEM
-					sb->resultval = -1;
-					return;
-				}
-				// this should improve responsiveness
-				SetThreadPriority(bsd->hThreads[i], THREAD_PRIORITY_ABOVE_NORMAL);
-				break;
-			}
-		}
-	}
-
-	unlocksigqueue ();
-
-	if (i >= MAX_SELECT_THREADS) {
-		write_log (_T("BSDSOCK: ERROR - Too many select()s, %d\n"), wscnt);
+	memset(&req, 0, sizeof req);
+	req.sb = sb;
+	req.wscnt = wscnt;
+	makesocktable(ctx, sb, readfds, &req.readsocks, nfds, INVALID_SOCKET, _T("R"));
+	makesocktable(ctx, sb, writefds, &req.writesocks, nfds, INVALID_SOCKET, _T("W"));
+	makesocktable(ctx, sb, exceptfds, &req.exceptsocks, nfds, INVALID_SOCKET, _T("E"));
+	if (timeout) {
+		tv.tv_sec = trap_get_long(ctx, timeout);
+		tv.tv_usec = trap_get_long(ctx, timeout + 4);
+		BSDTRACE((_T("(to: %d.%06d) "),tv.tv_sec,tv.tv_usec));
+		req.hastimeout = 1;
+		req.deadline = GetTickCount64() + (ULONGLONG)(uae_u32)tv.tv_sec * 1000 + ((uae_u32)tv.tv_usec + 999) / 1000;
+	}
+
+	if (timeout && !tv.tv_sec && !tv.tv_usec && !req.readsocks.fd_count && !req.writesocks.fd_count && !req.exceptsocks.fd_count) {
+		// select() fails with WSAEINVAL if all sets are empty
+		bsd->reactorDirect++;
+		req.resultval = 0;
+		sigs = 0;
+	} else if (timeout && !tv.tv_sec && !tv.tv_usec) {
+		// polling, no need to involve the reactor
+		bsd->reactorDirect++;
+		req.resultval = select(nfds + 1,
+			req.readsocks.fd_count ? &req.readsocks : NULL,
+			req.writesocks.fd_count ? &req.writesocks : NULL,
+			req.exceptsocks.fd_count ? &req.exceptsocks : NULL,
+			&tv);
+		if (req.resultval == SOCKET_ERROR)
+			req.err = WSAGetLastError();
+		sigs = 0;
 	} else {
-		SOCKET newsock = INVALID_SOCKET;
-
-		taw.sb = sb;
-		taw.nfds = nfds;
-		taw.readfds = readfds;
-		taw.writefds = writefds;
-		taw.exceptfds = exceptfds;
-		taw.timeout = timeout;
-		taw.wscnt = wscnt;
+		if (!start_reactor()) {
+			bsdsocklib_seterrno(ctx, sb, 12); // ENOMEM
+			sb->resultval = -1;
+			return;
+		}
 
-		bsd->threadargsw[i] = &taw;
+		ResetEvent(sb->hEvent);
 
-		SetEvent(bsd->hEvents[i]);
+		EnterCriticalSection(&bsd->csReactor);
+		req.next = bsd->selectreqs;
+		bsd->selectreqs = &req;
+		LeaveCriticalSection(&bsd->csReactor);
+		reactor_wake();
 
 		trap_call_add_dreg(ctx, 0, (((uae_u32)1) << sb->signal) | sb->eintrsigs | wssigs);
 		sigs = trap_call_lib(ctx, sb->sysbase, -0x13e);	// Wait()
-		/*
-		if ((1<<sb->signal) & sigs)
-		{ // 2.3.2002/SR Fix for AmiFTP -> Thread is ready, no need to Abort
-		sb->needAbort = 0;
-		}
-		*/
-		if (sb->needAbort) {
-			if ((newsock = socket(AF_INET,SOCK_STREAM,IPPROTO_TCP)) == INVALID_SOCKET)
-				write_log (_T("BSDSOCK: ERROR - Cannot create socket: %d, %d\n"), WSAGetLastError(),wscnt);
-			shutdown(sb->sockAbort,1);
-			if (newsock != sb->sockAbort) {
-				shutdown(sb->sockAbort, 1);
-				closesocket(sb->sockAbort);
-			}
-		}
+
+		EnterCriticalSection(&bsd->csReactor);
+		if (!req.done)
+			req.cancel = 1;
+		LeaveCriticalSection(&bsd->csReactor);
+		if (req.cancel)
+			reactor_wake();
 
 		WaitForSingleObject(sb->hEvent, INFINITE);
 
 		CANCELSIGNAL;
+	}
 
-		if (newsock != INVALID_SOCKET)
-			sb->sockAbort = newsock;
+	sb->resultval = req.resultval;
+	if (sb->resultval == SOCKET_ERROR) {
+		bsdsocklib_seterrno(ctx, sb, req.err - WSABASEERR);
+		BSDTRACE((_T("tWS2 failed %d:%d - "),sb->sb_errno,wscnt));
+		if (readfds)
+			fd_zero(ctx, readfds,nfds);
+		if (writefds)
+			fd_zero(ctx, writefds,nfds);
+		if (exceptfds)
+			fd_zero(ctx, exceptfds,nfds);
+	} else {
+		if (readfds)
+			makesockbitfield(ctx, sb,readfds,&req.readsocks,nfds);
+		if (writefds)
+			makesockbitfield(ctx, sb,writefds,&req.writesocks,nfds);
+		if (exceptfds)
+			makesockbitfield(ctx, sb,exceptfds,&req.exceptsocks,nfds);
+	}
 
-		if(sigmp)
-			trap_put_long(ctx, sigmp, sigs & wssigs);
+	if(sigmp)
+		trap_put_long(ctx, sigmp, sigs & wssigs);
 
-		if (sigs & wssigs) {
-			uae_u32 gotsigs = sigs & wssigs;
-			BSDTRACE((_T("[interrupted by signals 0x%08lx]:%d\n"), gotsigs, wscnt));
-			if (readfds) fd_zero(ctx, readfds,nfds);
-			if (writefds) fd_zero(ctx, writefds,nfds);
-			if (exceptfds) fd_zero(ctx, exceptfds,nfds);
-			bsdsocklib_seterrno(ctx, sb, 0);
-			sb->resultval = 0;
-		} else if (sigs & sb->eintrsigs) {
-			uae_u32 gotsigs = sigs & sb->eintrsigs;
-			BSDTRACE((_T("[interrupted 0x%08x]:%d\n"), gotsigs, wscnt));
-			sb->resultval = -1;
-			bsdsocklib_seterrno(ctx, sb, 4); // EINTR
-			/* EINTR signals are kept active */
-			trap_call_add_dreg(ctx, 0, gotsigs);
-			trap_call_add_dreg(ctx, 1, gotsigs);
-			trap_call_lib(ctx, sb->sysbase, -0x132); // SetSignal
-		}
+	if (sigs & wssigs) {
+		uae_u32 gotsigs = sigs & wssigs;
+		BSDTRACE((_T("[interrupted by signals 0x%08lx]:%d\n"), gotsigs, wscnt));
+		if (readfds) fd_zero(ctx, readfds,nfds);
+		if (writefds) fd_zero(ctx, writefds,nfds);
+		if (exceptfds) fd_zero(ctx, exceptfds,nfds);
+		bsdsocklib_seterrno(ctx, sb, 0);
+		sb->resultval = 0;
+	} else if (sigs & sb->eintrsigs) {
+		uae_u32 gotsigs = sigs & sb->eintrsigs;
+		BSDTRACE((_T("[interrupted 0x%08x]:%d\n"), gotsigs, wscnt));
+		sb->resultval = -1;
+		bsdsocklib_seterrno(ctx, sb, 4); // EINTR
+		/* EINTR signals are kept active */
+		trap_call_add_dreg(ctx, 0, gotsigs);
+		trap_call_add_dreg(ctx, 1, gotsigs);
+		trap_call_lib(ctx, sb->sysbase, -0x132); // SetSignal
+	}
 
-		if (sb->resultval >= 0) {
-			BSDTRACE((_T("WaitSelect, %d:%d\n"),sb->resultval,wscnt));
-		} else {
-			BSDTRACE((_T("WaitSelect error, %d errno %d:%d\n"),sb->resultval,sb->sb_errno,wscnt));
-		}
+	if (sb->resultval >= 0) {
+		BSDTRACE((_T("WaitSelect, %d:%d\n"),sb->resultval,wscnt));
+	} else {
+		BSDTRACE((_T("WaitSelect error, %d errno %d:%d\n"),sb->resultval,sb->sb_errno,wscnt));
 	}
 }
 
@@ -76,6 +76,14 @@
 #include "gfxboard.h"
 #include "devices.h"
 #include "statusline.h"
+#include "uae/vm.h"
+#include "vramwatch.h"
+
+#if defined(CPU_x86_64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define P96_SIMD 1
+#include <emmintrin.h>
+#define P96_SIMD_NOT(v) _mm_xor_si128(v, _mm_set1_epi32(-1))
+#endif
 
 int debug_rtg_blitter = 3;
 
@@ -102,6 +110,48 @@ static smp_comm_pipe *render_pipe;
 static volatile int render_thread_state;
 static CRITICAL_SECTION render_cs;
 
+#define RTG_CONVERT_THREADS 7
+#define RTG_CONVERT_MIN_ROWS 32
+#define RTG_CONVERT_CHUNK 8
+
+struct rtg_convert_row
+{
+	// scaled rows: x is the source row
+	int x, y, width;
+	uae_u8 *src;
+};
+struct rtg_convert_scale
+{
+	uae_u8 *src_screen;
+	int sx, sxadd;
+	int screenbytesperrow, screenpixbytes;
+	int dx, dstwidth, dstheight;
+	bool ck;
+	uae_u32 colorkey;
+	int convert_mode;
+	uae_u32 *rgbx16, *clut;
+	bool yuv_swap;
+};
+struct rtg_convert_job
+{
+	int monid;
+	uae_u8 *src, *dst;
+	int srcbytesperrow, srcpixbytes;
+	int dstbytesperrow, dstpixbytes;
+	int *convert;
+	struct rtg_convert_scale *scale;
+	struct rtg_convert_row *rows;
+	int count, max;
+	volatile uae_atomic next;
+};
+static struct rtg_convert_job rtg_convert, *rtg_convert_current;
+static CRITICAL_SECTION rtg_convert_cs;
+static uae_thread_id rtg_convert_tid[RTG_CONVERT_THREADS];
+static uae_sem_t rtg_convert_start[RTG_CONVERT_THREADS];
+static uae_sem_t rtg_convert_done;
+static volatile bool rtg_convert_quit;
+static int rtg_convert_threads = -1;
+
 #define PICASSO_STATE_SETDISPLAY 1
 #define PICASSO_STATE_SETPANNING 2
 #define PICASSO_STATE_SETGC 4
@@ -697,9 +747,17 @@ static void do_fillrect_frame_buffer(struct RenderInfo *ri, int X, int Y, int Wi
 	case 2:
 	{
 		Pen |= Pen << 16;
+#ifdef P96_SIMD
+		__m128i vpen = _mm_set1_epi32(Pen);
+#endif
 		for (int lines = 0; lines < Height; lines++, dst += bpr) {
 			uae_u32 *p = (uae_u32*)dst;
-			for (cols = 0; cols < (Width & ~15); cols += 16) {
+			cols = 0;
+#ifdef P96_SIMD
+			for (; cols < (Width & ~7); cols += 8, p += 4)
+				_mm_storeu_si128((__m128i*)p, vpen);
+#endif
+			for (; cols < (Width & ~15); cols += 16) {
 				*p++ = Pen;
 				*p++ = Pen;
 				*p++ = Pen;
@@ -757,9 +815,17 @@ static void do_fillrect_frame_buffer(struct RenderInfo *ri, int X, int Y, int Wi
 	break;
 	case 4:
 	{
+#ifdef P96_SIMD
+		__m128i vpen = _mm_set1_epi32(Pen);
+#endif
 		for (int lines = 0; lines < Height; lines++, dst += bpr) {
 			uae_u32 *p = (uae_u32*)dst;
-			for (cols = 0; cols < (Width & ~7); cols += 8) {
+			cols = 0;
+#ifdef P96_SIMD
+			for (; cols < (Width & ~3); cols += 4, p += 4)
+				_mm_storeu_si128((__m128i*)p, vpen);
+#endif
+			for (; cols < (Width & ~7); cols += 8) {
 				*p++ = Pen;
 				*p++ = Pen;
 				*p++ = Pen;
@@ -1349,45 +1415,59 @@ static void picasso_handle_hsync(void)
 #define BLT_MULT 1
 #define BLT_NAME BLIT_FALSE_32
 #define BLT_FUNC(s,d) *d = 0
+#define BLT_FUNC_SIMD(s,d) _mm_setzero_si128()
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOR_32
 #define BLT_FUNC(s,d) *d = ~((*s) | (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_or_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYDST_32
 #define BLT_FUNC(s,d) *d = (*d) & ~(*s)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTSRC_32
 #define BLT_FUNC(s,d) *d = ~(*s)
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYSRC_32
 #define BLT_FUNC(s,d) *d = (*s) & ((~(*d)) & rgbmask)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, _mm_andnot_si128(d, vrgbmask))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTDST_32
 #define BLT_FUNC(s,d) *d = (~(*d)) & rgbmask
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(d, vrgbmask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_EOR_32
 #define BLT_FUNC(s,d) *d = (*s) ^ (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_xor_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NAND_32
 #define BLT_FUNC(s,d) *d = ~((*s) & (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_and_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_AND_32
 #define BLT_FUNC(s,d) *d = (*s) & (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NEOR_32
 #define BLT_FUNC(s,d) *d = ~((*s) ^ (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_xor_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYSRC_32
 #define BLT_FUNC(s,d) *d = ~(*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(s), d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYDST_32
 #define BLT_FUNC(s,d) *d = ((~(*d)) & rgbmask) | (*s)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(_mm_andnot_si128(d, vrgbmask), s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_OR_32
 #define BLT_FUNC(s,d) *d = (*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_TRUE_32
 #define BLT_FUNC(s,d) *d = 0xffffffff
+#define BLT_FUNC_SIMD(s,d) _mm_set1_epi32(-1)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_SWAP_32
 #define BLT_FUNC(s,d) { uae_u16 tmp = *d ; *d = *s; *s = tmp; }
@@ -1399,45 +1479,59 @@ static void picasso_handle_hsync(void)
 #define BLT_MULT 1
 #define BLT_NAME BLIT_FALSE_24
 #define BLT_FUNC(s,d) *d = 0
+#define BLT_FUNC_SIMD(s,d) _mm_setzero_si128()
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOR_24
 #define BLT_FUNC(s,d) *d = ~((*s) | (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_or_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYDST_24
 #define BLT_FUNC(s,d) *d = (*d) & ~(*s)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTSRC_24
 #define BLT_FUNC(s,d) *d = ~(*s)
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYSRC_24
 #define BLT_FUNC(s,d) *d = (*s) & (~(*d))
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(d, s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTDST_24
 #define BLT_FUNC(s,d) *d = (~(*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_EOR_24
 #define BLT_FUNC(s,d) *d = (*s) ^ (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_xor_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NAND_24
 #define BLT_FUNC(s,d) *d = ~((*s) & (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_and_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_AND_24
 #define BLT_FUNC(s,d) *d = (*s) & (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NEOR_24
 #define BLT_FUNC(s,d) *d = ~((*s) ^ (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_xor_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYSRC_24
 #define BLT_FUNC(s,d) *d = ~(*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(s), d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYDST_24
 #define BLT_FUNC(s,d) *d = (~(*d)) | (*s)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(d), s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_OR_24
 #define BLT_FUNC(s,d) *d = (*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_TRUE_24
 #define BLT_FUNC(s,d) *d = 0xffffffff
+#define BLT_FUNC_SIMD(s,d) _mm_set1_epi32(-1)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_SWAP_24
 #define BLT_FUNC(s,d) { uae_u32 tmp = *d; *d = *s; *s = tmp; }
@@ -1449,45 +1543,59 @@ static void picasso_handle_hsync(void)
 #define BLT_MULT 2
 #define BLT_NAME BLIT_FALSE_16
 #define BLT_FUNC(s,d) *d = 0
+#define BLT_FUNC_SIMD(s,d) _mm_setzero_si128()
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOR_16
 #define BLT_FUNC(s,d) *d = ~((*s) | (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_or_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYDST_16
 #define BLT_FUNC(s,d) *d = (*d) & ~(*s)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTSRC_16
 #define BLT_FUNC(s,d) *d = ~(*s)
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYSRC_16
 #define BLT_FUNC(s,d) *d = (*s) & ((~(*d)) & rgbmask)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, _mm_andnot_si128(d, vrgbmask))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTDST_16
 #define BLT_FUNC(s,d) *d = ((~(*d)) & rgbmask)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(d, vrgbmask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_EOR_16
 #define BLT_FUNC(s,d) *d = (*s) ^ (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_xor_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NAND_16
 #define BLT_FUNC(s,d) *d = ~((*s) & (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_and_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_AND_16
 #define BLT_FUNC(s,d) *d = (*s) & (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NEOR_16
 #define BLT_FUNC(s,d) *d = ~((*s) ^ (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_xor_si128(s, d))
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYSRC_16
 #define BLT_FUNC(s,d) *d = ~(*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(s), d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYDST_16
 #define BLT_FUNC(s,d) *d = ((~(*d)) & rgbmask) | (*s)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(_mm_andnot_si128(d, vrgbmask), s)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_OR_16
 #define BLT_FUNC(s,d) *d = (*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(s, d)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_TRUE_16
 #define BLT_FUNC(s,d) *d = 0xffff
+#define BLT_FUNC_SIMD(s,d) _mm_set1_epi32(-1)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_SWAP_16
 #define BLT_FUNC(s,d) { uae_u16 tmp = *d; *d = *s; *s = tmp; }
@@ -1500,76 +1608,91 @@ static void picasso_handle_hsync(void)
 #define BLT_NAME BLIT_FALSE_8
 #define BLT_NAME_MASK BLIT_FALSE_MASK_8
 #define BLT_FUNC(s,d) *d = 0
+#define BLT_FUNC_SIMD(s,d) _mm_setzero_si128()
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((0) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOR_8
 #define BLT_NAME_MASK BLIT_NOR_MASK_8
 #define BLT_FUNC(s,d) *d = ~((*s) | (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_or_si128(s, d))
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~((*s) | (*d))) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYDST_8
 #define BLT_NAME_MASK BLIT_ONLYDST_MASK_8
 #define BLT_FUNC(s,d) *d = (*d) & ~(*s)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(s, d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*d) & ~(*s)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTSRC_8
 #define BLT_NAME_MASK BLIT_NOTSRC_MASK_8
 #define BLT_FUNC(s,d) *d = ~(*s)
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(s)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~(*s)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_ONLYSRC_8
 #define BLT_NAME_MASK BLIT_ONLYSRC_MASK_8
 #define BLT_FUNC(s,d) *d = (*s) & ~(*d)
+#define BLT_FUNC_SIMD(s,d) _mm_andnot_si128(d, s)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*s) & ~(*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTDST_8
 #define BLT_NAME_MASK BLIT_NOTDST_MASK_8
 #define BLT_FUNC(s,d) *d = ~(*d)
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~(*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_EOR_8
 #define BLT_NAME_MASK BLIT_EOR_MASK_8
 #define BLT_FUNC(s,d) *d = (*s) ^ (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_xor_si128(s, d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*s) ^ (*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NAND_8
 #define BLT_NAME_MASK BLIT_NAND_MASK_8
 #define BLT_FUNC(s,d) *d = ~((*s) & (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_and_si128(s, d))
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~((*s) & (*d))) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_AND_8
 #define BLT_NAME_MASK BLIT_AND_MASK_8
 #define BLT_FUNC(s,d) *d = (*s) & (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_and_si128(s, d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*s) & (*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NEOR_8
 #define BLT_NAME_MASK BLIT_NEOR_MASK_8
 #define BLT_FUNC(s,d) *d = ~((*s) ^ (*d))
+#define BLT_FUNC_SIMD(s,d) P96_SIMD_NOT(_mm_xor_si128(s, d))
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~((*s) ^ (*d))) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYSRC_8
 #define BLT_NAME_MASK BLIT_NOTONLYSRC_MASK_8
 #define BLT_FUNC(s,d) *d = ~(*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(s), d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~(*s) | (*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_SRC_8
 #define BLT_NAME_MASK BLIT_SRC_MASK_8
 #define BLT_FUNC(s,d) *d = *s
-#define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*s) | (*d)) & mask)
+#define BLT_FUNC_SIMD(s,d) s
+#define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((*s) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_NOTONLYDST_8
 #define BLT_NAME_MASK BLIT_NOTONLYDST_MASK_8
 #define BLT_FUNC(s,d) *d = ~(*d) | (*s)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(P96_SIMD_NOT(d), s)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((~(*d) | (*s)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_OR_8
 #define BLT_NAME_MASK BLIT_OR_MASK_8
 #define BLT_FUNC(s,d) *d = (*s) | (*d)
+#define BLT_FUNC_SIMD(s,d) _mm_or_si128(s, d)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | (((*s) | (*d)) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_TRUE_8
 #define BLT_NAME_MASK BLIT_TRUE_MASK_8
 #define BLT_FUNC(s,d) *d = 0xff
+#define BLT_FUNC_SIMD(s,d) _mm_set1_epi32(-1)
 #define BLT_FUNC_MASK(s,d,mask) *d = ((*d) & ~mask) | ((0xff) & mask)
 #include "../p96_blit.cpp"
 #define BLT_NAME BLIT_SWAP_8
@@ -2393,31 +2516,51 @@ static void CopyLibResolutionStructureU2A(TrapContext *ctx, struct LibResolution
 	trap_put_long(ctx, amigamemptr + PSSO_LibResolution_BoardInfo, libres->BoardInfo);
 }
 
-void picasso_allocatewritewatch (int index, int gfxmemsize)
+static uae_u32 *gwwfound[MAX_RTG_BOARDS];
+static int gwwwords[MAX_RTG_BOARDS];
+
+static void picasso_resetwritewatch(int index)
 {
-	SYSTEM_INFO si;
+	vramwatch_reset(index, gfxmem_banks[index]->start + natmem_offset, gfxmem_banks[index]->allocated_size);
+}
 
+void picasso_allocatewritewatch (int index, int gfxmemsize)
+{
 	xfree (gwwbuf[index]);
-	GetSystemInfo (&si);
-	gwwpagesize[index] = si.dwPageSize;
+	xfree (gwwfound[index]);
+	gwwpagesize[index] = uae_vm_page_size();
 	gwwbufsize[index] = gfxmemsize / gwwpagesize[index] + 1;
 	gwwpagemask[index] = gwwpagesize[index] - 1;
 	gwwbuf[index] = xmalloc (void*, gwwbufsize[index]);
+	gwwwords[index] = (gwwbufsize[index] + 31) / 32 + 1;
+	gwwfound[index] = xcalloc (uae_u32, gwwwords[index]);
+	vramwatch_alloc(index, gfxmemsize);
 }
 
-static ULONG_PTR writewatchcount[MAX_RTG_BOARDS];
+static uae_u32 writewatchcount[MAX_RTG_BOARDS];
 static int watch_offset[MAX_RTG_BOARDS];
 int picasso_getwritewatch (int index, int offset, uae_u8 ***gwwbufp, uae_u8 **startp)
 {
-	ULONG ps;
+	uae_u8 *base = gfxmem_banks[index]->start + natmem_offset;
+	uae_u8 *start = base + offset;
 	writewatchcount[index] = gwwbufsize[index];
 	watch_offset[index] = offset;
-	uae_u8 *start = gfxmem_banks[index]->start + natmem_offset + offset;
-	if (GetWriteWatch (WRITE_WATCH_FLAG_RESET, gfxmem_banks[index]->start + natmem_offset + offset, (gwwbufsize[index] - 1) * gwwpagesize[index], gwwbuf[index], &writewatchcount[index], &ps)) {
-		write_log (_T("picasso_getwritewatch %d\n"), GetLastError ());
+	uae_u32 *found = gwwfound[index];
+	// stale pages from the previous scan must not stay dirty
+	memset(found, 0, gwwwords[index] * sizeof(uae_u32));
+	if (vramwatch_region(index, base, start, (gwwbufsize[index] - 1) * gwwpagesize[index], gwwbuf[index], &writewatchcount[index])) {
 		writewatchcount[index] = 0;
 		return -1;
 	}
+	int shift = vramwatch_shift(index);
+	for (uae_u32 i = 0; i < writewatchcount[index]; i++) {
+		uae_u8 *p = (uae_u8*)gwwbuf[index][i];
+		if (p < start)
+			gwwbuf[index][i] = p = start;
+		uae_u32 page = (uae_u32)(p - base) >> shift;
+		if (page < gwwbufsize[index])
+			found[page >> 5] |= 1 << (page & 31);
+	}
 	if (gwwbufp)
 		*gwwbufp = (uae_u8**)gwwbuf[index];
 	if (startp)
@@ -2426,25 +2569,18 @@ int picasso_getwritewatch (int index, int offset, uae_u8 ***gwwbufp, uae_u8 **st
 }
 bool picasso_is_vram_dirty (int index, uaecptr addr, int size)
 {
-	static ULONG_PTR last;
-	uae_u8 *a = addr + natmem_offset + watch_offset[index];
-	int s = size;
-	int ms = gwwpagesize[index];
-
-	for (;;) {
-		for (ULONG_PTR i = last; i < writewatchcount[index]; i++) {
-			uae_u8 *ma = (uae_u8*)gwwbuf[index][i];
-			if (
-				(a < ma && a + s >= ma) ||
-				(a < ma + ms && a + s >= ma + ms) ||
-				(a >= ma && a < ma + ms)) {
-				last = i;
-				return true;
-			}
-		}
-		if (last == 0)
-			break;
-		last = 0;
+	uae_u32 *found = gwwfound[index];
+	if (!found)
+		return false;
+	int shift = vramwatch_shift(index);
+	uae_u32 offset = addr + watch_offset[index] - gfxmem_banks[index]->start;
+	uae_u32 first = offset >> shift;
+	uae_u32 last = (offset + size) >> shift;
+	if (last >= (uae_u32)gwwbufsize[index])
+		last = gwwbufsize[index] - 1;
+	for (uae_u32 p = first; p <= last; p++) {
+		if (found[p >> 5] & (1 << (p & 31)))
+			return true;
 	}
 	return false;
 }
@@ -3085,7 +3221,7 @@ static void init_picasso_screen(int monid)
 		picasso_refresh(monid);
 	}
 	init_picasso_screen_called = 1;
-	mman_ResetWatch (gfxmem_bank.start + natmem_offset, gfxmem_bank.allocated_size);
+	picasso_resetwritewatch(0);
 
 }
 
@@ -3249,6 +3385,14 @@ static void do_xor8(uae_u8 *p, int w, uae_u32 v)
 		p++;
 		w--;
 	}
+#ifdef P96_SIMD
+	__m128i xv = _mm_set1_epi32(v);
+	while (w >= 16) {
+		_mm_storeu_si128((__m128i*)p, _mm_xor_si128(_mm_loadu_si128((__m128i*)p), xv));
+		p += 16;
+		w -= 16;
+	}
+#endif
 	uae_u64 vv = v | ((uae_u64)v << 32);
 	while (w >= 2 * 8) {
 		*((uae_u64*)p) ^= vv;
@@ -3271,6 +3415,14 @@ static void do_xor8(uae_u8 *p, int w, uae_u32 v)
 		p++;
 		w--;
 	}
+#ifdef P96_SIMD
+	__m128i xv = _mm_set1_epi32(v);
+	while (w >= 16) {
+		_mm_storeu_si128((__m128i*)p, _mm_xor_si128(_mm_loadu_si128((__m128i*)p), xv));
+		p += 16;
+		w -= 16;
+	}
+#endif
 	while (w >= 2 * 4) {
 		*((uae_u32*)p) ^= v;
 		p += 4;
@@ -3616,6 +3768,41 @@ STATIC_INLINE void PixelWrite(uae_u8 *mem, int bits, uae_u32 fgpen, int Bpp, uae
 	}
 }
 
+#ifdef P96_SIMD
+/* expand 8 template bits (msb first) to 8 pixels, 16 and 32-bit only. JAM1 keeps clear pixels. */
+static bool PixelWrite8(uae_u8 *mem, uae_u8 bits, uae_u32 fgpen, uae_u32 bgpen, int Bpp, bool jam1)
+{
+	if (Bpp == 4) {
+		const __m128i sel0 = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+		const __m128i sel1 = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+		__m128i b = _mm_set1_epi32(bits);
+		__m128i fg = _mm_set1_epi32(fgpen);
+		__m128i m0 = _mm_cmpeq_epi32(_mm_and_si128(b, sel0), sel0);
+		__m128i m1 = _mm_cmpeq_epi32(_mm_and_si128(b, sel1), sel1);
+		__m128i bg0, bg1;
+		if (jam1) {
+			bg0 = _mm_loadu_si128((__m128i*)mem);
+			bg1 = _mm_loadu_si128((__m128i*)(mem + 16));
+		} else {
+			bg0 = bg1 = _mm_set1_epi32(bgpen);
+		}
+		_mm_storeu_si128((__m128i*)mem, _mm_or_si128(_mm_and_si128(m0, fg), _mm_andnot_si128(m0, bg0)));
+		_mm_storeu_si128((__m128i*)(mem + 16), _mm_or_si128(_mm_and_si128(m1, fg), _mm_andnot_si128(m1, bg1)));
+		return true;
+	}
+	if (Bpp == 2) {
+		const __m128i sel = _mm_set_epi16(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80);
+		__m128i b = _mm_set1_epi16(bits);
+		__m128i fg = _mm_set1_epi16((uae_s16)fgpen);
+		__m128i m = _mm_cmpeq_epi16(_mm_and_si128(b, sel), sel);
+		__m128i bg = jam1 ? _mm_loadu_si128((__m128i*)mem) : _mm_set1_epi16((uae_s16)bgpen);
+		_mm_storeu_si128((__m128i*)mem, _mm_or_si128(_mm_and_si128(m, fg), _mm_andnot_si128(m, bg)));
+		return true;
+	}
+	return false;
+}
+#endif
+
 /*
 * BlitPattern:
 *
@@ -3720,6 +3907,16 @@ static uae_u32 REGPARAM2 picasso_BlitPattern(TrapContext *ctx)
 				if (max > 16)
 					max = 16;
 
+#ifdef P96_SIMD
+				if (max == 16 && (pattern.DrawMode == JAM1 || pattern.DrawMode == JAM2)) {
+					uae_u16 pd = inversion ? ~data : data;
+					bool jam1 = pattern.DrawMode == JAM1;
+					if (PixelWrite8(uae_mem2, pd >> 8, fgpen, bgpen, Bpp, jam1)) {
+						PixelWrite8(uae_mem2 + Bpp * 8, (uae_u8)pd, fgpen, bgpen, Bpp, jam1);
+						continue;
+					}
+				}
+#endif
 				switch (pattern.DrawMode)
 				{
 				case JAM1:
@@ -3890,6 +4087,12 @@ static uae_u32 REGPARAM2 picasso_BlitTemplate(TrapContext *ctx)
 
 				byte = data >> (8 - bitoffset);
 
+#ifdef P96_SIMD
+				if (max == 8 && (tmp.DrawMode == JAM1 || tmp.DrawMode == JAM2)) {
+					if (PixelWrite8(uae_mem2, (uae_u8)(inversion ? ~byte : byte), fgpen, bgpen, Bpp, tmp.DrawMode == JAM1))
+						continue;
+				}
+#endif
 				switch (tmp.DrawMode)
 				{
 				case JAM1:
@@ -5382,6 +5585,7 @@ static void picasso_flushoverlay(int index, uae_u8 *src, int scr_offset, uae_u8
 	int my = overlay_src_height_in * 256 / overlay_h;
 	int y = 0;
 	int split = 0;
+	int rows = 0;
 	if (vidinfo->splitypos >= 0) {
 		split = vidinfo->splitypos;
 	}
@@ -5392,14 +5596,15 @@ static void picasso_flushoverlay(int index, uae_u8 *src, int scr_offset, uae_u8
 			break;
 		if (dst + (overlay_y + dy + split) * vidinfo->rowbytes > vram_end)
 			break;
-		copyrow_scale(monid, s, ss, dst,
-			0, (y >> 8), mx, overlay_src_width_in, overlay_src_width * overlay_pix, overlay_pix,
-			state->BytesPerRow, state->BytesPerPixel,
-			overlay_x, overlay_y + dy + split, vidinfo->width, vidinfo->height, vidinfo->rowbytes, vidinfo->pixbytes,
-			overlay_occlusion != 0, overlay_color,
-			overlay_convert, p96_rgbx16_ovl, overlay_clut, true);
+		rows++;
 		y += my;
 	}
+	copyrows_scale(monid, s, ss, dst,
+		0, 0, my, rows, mx, overlay_src_width_in, overlay_src_width * overlay_pix, overlay_pix,
+		state->BytesPerRow, state->BytesPerPixel,
+		overlay_x, overlay_y + split, vidinfo->width, vidinfo->height, vidinfo->rowbytes, vidinfo->pixbytes,
+		overlay_occlusion != 0, overlay_color,
+		overlay_convert, p96_rgbx16_ovl, overlay_clut, true);
 }
 
 void fb_copyrow(int monid, uae_u8 *src, uae_u8 *dst, int x, int y, int width, int srcpixbytes, int dy)
@@ -5427,13 +5632,242 @@ static void copyallinvert(int monid, uae_u8 *src, uae_u8 *dst, int pwidth, int p
 	}
 }
 
+/*
+ * Row conversion worker pool. picasso_flushpixels() collects dirty rows
+ * into rtg_convert.rows and rtg_convert_flush() hands them out in small
+ * chunks to the workers, the calling thread converts rows too. copyrow()
+ * and copyrow_scale() only read shared state so rows can be converted in
+ * any order.
+ */
+static void rtg_convert_row(struct rtg_convert_job *j, struct rtg_convert_row *r)
+{
+	struct rtg_convert_scale *sc = j->scale;
+
+	if (sc) {
+		copyrow_scale(j->monid, j->src, sc->src_screen, j->dst,
+			sc->sx, r->x, sc->sxadd, r->width, j->srcbytesperrow, j->srcpixbytes,
+			sc->screenbytesperrow, sc->screenpixbytes,
+			sc->dx, r->y, sc->dstwidth, sc->dstheight, j->dstbytesperrow, j->dstpixbytes,
+			sc->ck, sc->colorkey,
+			sc->convert_mode, sc->rgbx16, sc->clut, sc->yuv_swap);
+	} else if (r->src) {
+		copyrow(j->monid, r->src, j->dst, r->x, 0, r->width, 0, j->srcpixbytes,
+			r->x, r->y, j->dstbytesperrow, j->dstpixbytes, j->convert, p96_rgbx16);
+	} else {
+		copyrow(j->monid, j->src, j->dst, r->x, r->y, r->width, j->srcbytesperrow, j->srcpixbytes,
+			r->x, r->y, j->dstbytesperrow, j->dstpixbytes, j->convert, p96_rgbx16);
+	}
+}
+
+static void rtg_convert_rows(struct rtg_convert_job *j)
+{
+	for (;;) {
+		int i = (atomic_inc(&j->next) - 1) * RTG_CONVERT_CHUNK;
+		if (i >= j->count)
+			break;
+		int end = i + RTG_CONVERT_CHUNK;
+		if (end > j->count)
+			end = j->count;
+		for (; i < end; i++) {
+			rtg_convert_row(j, &j->rows[i]);
+		}
+	}
+}
+
+static void rtg_convert_thread(void *v)
+{
+	int num = (int)(uintptr_t)v;
+	for (;;) {
+		uae_sem_wait(&rtg_convert_start[num]);
+		if (rtg_convert_quit)
+			break;
+		rtg_convert_rows(rtg_convert_current);
+		uae_sem_post(&rtg_convert_done);
+	}
+	uae_sem_post(&rtg_convert_done);
+}
+
+static void rtg_convert_init(void)
+{
+	int cpus;
+
+	if (rtg_convert_threads >= 0)
+		return;
+	rtg_convert_threads = 0;
+	InitializeCriticalSection(&rtg_convert_cs);
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	cpus = si.dwNumberOfProcessors;
+	// calling thread converts too, leave one core for emulation
+	cpus -= 2;
+	if (cpus > RTG_CONVERT_THREADS)
+		cpus = RTG_CONVERT_THREADS;
+	if (cpus <= 0)
+		return;
+	rtg_convert_quit = false;
+	uae_sem_init(&rtg_convert_done, 0, 0);
+	for (int i = 0; i < cpus; i++) {
+		uae_sem_init(&rtg_convert_start[i], 0, 0);
+		if (!uae_start_thread(_T("rtgconvert"), rtg_convert_thread, (void*)(uintptr_t)i, &rtg_convert_tid[i])) {
+			uae_sem_destroy(&rtg_convert_start[i]);
+			break;
+		}
+		rtg_convert_threads++;
+	}
+	write_log(_T("RTG: %d conversion threads\n"), rtg_convert_threads);
+}
+
+static void rtg_convert_free(void)
+{
+	if (rtg_convert_threads > 0) {
+		rtg_convert_quit = true;
+		for (int i = 0; i < rtg_convert_threads; i++)
+			uae_sem_post(&rtg_convert_start[i]);
+		for (int i = 0; i < rtg_convert_threads; i++) {
+			uae_wait_thread(rtg_convert_tid[i]);
+			uae_sem_destroy(&rtg_convert_start[i]);
+		}
+		uae_sem_destroy(&rtg_convert_done);
+	}
+	if (rtg_convert_threads >= 0)
+		DeleteCriticalSection(&rtg_convert_cs);
+	rtg_convert_threads = -1;
+	xfree(rtg_convert.rows);
+	rtg_convert.rows = NULL;
+	rtg_convert.max = 0;
+}
+
+static void rtg_convert_begin(struct rtg_convert_job *j, int monid, uae_u8 *src, uae_u8 *dst, int srcbytesperrow, int srcpixbytes, int dstbytesperrow, int dstpixbytes, int *mode_convert)
+{
+	j->monid = monid;
+	j->src = src;
+	j->dst = dst;
+	j->srcbytesperrow = srcbytesperrow;
+	j->srcpixbytes = srcpixbytes;
+	j->dstbytesperrow = dstbytesperrow;
+	j->dstpixbytes = dstpixbytes;
+	j->convert = mode_convert;
+	j->scale = NULL;
+	j->count = 0;
+}
+
+static void rtg_convert_addrow(struct rtg_convert_job *j, uae_u8 *src, int x, int y, int width)
+{
+	struct rtg_convert_row tmp;
+
+	if (j->count >= j->max) {
+		int max = j->max ? j->max * 2 : 1024;
+		struct rtg_convert_row *rows = xrealloc(struct rtg_convert_row, j->rows, max);
+		if (!rows) {
+			tmp.x = x;
+			tmp.y = y;
+			tmp.width = width;
+			tmp.src = src;
+			rtg_convert_row(j, &tmp);
+			return;
+		}
+		j->rows = rows;
+		j->max = max;
+	}
+	struct rtg_convert_row *r = &j->rows[j->count++];
+	r->x = x;
+	r->y = y;
+	r->width = width;
+	r->src = src;
+}
+
+static void rtg_convert_add(struct rtg_convert_job *j, int x, int y, int width)
+{
+	rtg_convert_addrow(j, NULL, x, y, width);
+}
+
+static void rtg_convert_flush(struct rtg_convert_job *j)
+{
+	int threads = 0;
+
+	if (!j->count)
+		return;
+	j->next = 0;
+	if (j->count >= RTG_CONVERT_MIN_ROWS && rtg_convert_threads > 0) {
+		threads = (j->count + RTG_CONVERT_MIN_ROWS - 1) / RTG_CONVERT_MIN_ROWS - 1;
+		if (threads > rtg_convert_threads)
+			threads = rtg_convert_threads;
+	}
+	if (threads > 0) {
+		// one job at a time in the pool (render thread vs screenshots)
+		EnterCriticalSection(&rtg_convert_cs);
+		rtg_convert_current = j;
+		for (int i = 0; i < threads; i++)
+			uae_sem_post(&rtg_convert_start[i]);
+		rtg_convert_rows(j);
+		for (int i = 0; i < threads; i++)
+			uae_sem_wait(&rtg_convert_done);
+		rtg_convert_current = NULL;
+		LeaveCriticalSection(&rtg_convert_cs);
+	} else {
+		rtg_convert_rows(j);
+	}
+	j->count = 0;
+}
+
 static void copyall(int monid, uae_u8 *src, uae_u8 *dst, int pwidth, int pheight, int srcbytesperrow, int srcpixbytes, int dstbytesperrow, int dstpixbytes, int *mode_convert)
 {
-	struct picasso_vidbuf_description *vidinfo = &picasso_vidinfo[monid];
+	struct rtg_convert_job j = { 0 };
 
+	rtg_convert_begin(&j, monid, src, dst, srcbytesperrow, srcpixbytes, dstbytesperrow, dstpixbytes, mode_convert);
 	for (int y = 0; y < pheight; y++) {
-		copyrow(monid, src, dst, 0, y, pwidth, srcbytesperrow, srcpixbytes, 0, y, dstbytesperrow, dstpixbytes, mode_convert, p96_rgbx16);
+		rtg_convert_add(&j, 0, y, pwidth);
 	}
+	rtg_convert_flush(&j);
+	xfree(j.rows);
+}
+
+// one source row pointer per destination row
+void fb_copyrows(int monid, uae_u8 **src, uae_u8 *dst, int width, int height, int srcpixbytes)
+{
+	struct picasso_vidbuf_description *vidinfo = &picasso_vidinfo[monid];
+	struct rtg_convert_job j = { 0 };
+
+	rtg_convert_begin(&j, monid, NULL, dst, 0, srcpixbytes, vidinfo->rowbytes, vidinfo->pixbytes, vidinfo->picasso_convert);
+	for (int y = 0; y < height; y++) {
+		rtg_convert_addrow(&j, src[y], 0, y, width);
+	}
+	rtg_convert_flush(&j);
+	xfree(j.rows);
+}
+
+// copyrow_scale() for rows destination rows starting at dy, source row of row n is (sy + n * syadd) >> 8
+void copyrows_scale(int monid, uae_u8 *src, uae_u8 *src_screen, uae_u8 *dst,
+	int sx, int sy, int syadd, int rows, int sxadd, int width, int srcbytesperrow, int srcpixbytes,
+	int screenbytesperrow, int screenpixbytes,
+	int dx, int dy, int dstwidth, int dstheight, int dstbytesperrow, int dstpixbytes,
+	bool ck, uae_u32 colorkey,
+	int convert_mode, uae_u32 *p96_rgbx16p, uae_u32 *clut, bool yuv_swap)
+{
+	struct rtg_convert_scale sc;
+	struct rtg_convert_job j = { 0 };
+
+	sc.src_screen = src_screen;
+	sc.sx = sx;
+	sc.sxadd = sxadd;
+	sc.screenbytesperrow = screenbytesperrow;
+	sc.screenpixbytes = screenpixbytes;
+	sc.dx = dx;
+	sc.dstwidth = dstwidth;
+	sc.dstheight = dstheight;
+	sc.ck = ck;
+	sc.colorkey = colorkey;
+	sc.convert_mode = convert_mode;
+	sc.rgbx16 = p96_rgbx16p;
+	sc.clut = clut;
+	sc.yuv_swap = yuv_swap;
+	rtg_convert_begin(&j, monid, src, dst, srcbytesperrow, srcpixbytes, dstbytesperrow, dstpixbytes, NULL);
+	j.scale = &sc;
+	for (int i = 0; i < rows; i++) {
+		rtg_convert_add(&j, (sy + i * syadd) >> 8, dy + i, width);
+	}
+	rtg_convert_flush(&j);
+	xfree(j.rows);
 }
 
 uae_u8 *uaegfx_getrtgbuffer(int monid, int *widthp, int *heightp, int *pitch, int *depth, uae_u8 *palette)
@@ -5496,7 +5930,7 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 	struct picasso96_state_struct *state = &picasso96_state[monid];
 	uae_u8 *src_start[2];
 	uae_u8 *src_end[2];
-	ULONG_PTR gwwcnt;
+	uae_u32 gwwcnt;
 	int pwidth = state->Width > state->VirtualWidth ? state->VirtualWidth : state->Width;
 	int pheight = state->Height > state->VirtualHeight ? state->VirtualHeight : state->Height;
 	int maxy = -1;
@@ -5542,11 +5976,11 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 		}
 
 		if (!index && overlay_vram && overlay_active) {
-			ULONG ps;
 			gwwcnt = gwwbufsize[index];
 			uae_u8 *ovr_start = src + (overlay_vram_offset & ~gwwpagemask[index]);
 			uae_u8 *ovr_end = src + ((overlay_vram_offset + overlay_src_width * overlay_src_height * overlay_pix + gwwpagesize[index] - 1) & ~gwwpagemask[index]);
-			mman_GetWriteWatch(ovr_start, ovr_end - ovr_start, gwwbuf[index], &gwwcnt, &ps);
+			if (vramwatch_region(index, src, ovr_start, (uae_u32)(ovr_end - ovr_start), gwwbuf[index], &gwwcnt))
+				gwwcnt = 1;
 			overlay_updated = gwwcnt > 0;
 		}
 
@@ -5563,10 +5997,13 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 				for (int i = 0; i < gwwcnt; i++)
 					gwwbuf[index][i] = src_start[split] + i * gwwpagesize[index];
 			} else {
-				ULONG ps;
 				gwwcnt = gwwbufsize[index];
-				if (mman_GetWriteWatch(src_start[split], regionsize, gwwbuf[index], &gwwcnt, &ps))
-					continue;
+				if (vramwatch_region(index, src, src_start[split], regionsize, gwwbuf[index], &gwwcnt)) {
+					// no dirty tracking: convert the whole region
+					gwwcnt = regionsize / gwwpagesize[index] + 1;
+					for (int i = 0; i < gwwcnt; i++)
+						gwwbuf[index][i] = src_start[split] + i * gwwpagesize[index];
+				}
 			}
 
 			matchcount += (int)gwwcnt;
@@ -5630,6 +6067,8 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 				off = 0;
 			}
 
+			rtg_convert_begin(&rtg_convert, monid, src + off, dst, state->BytesPerRow, state->BytesPerPixel,
+				vidinfo->rowbytes, vidinfo->pixbytes, vidinfo->picasso_convert);
 			for (int i = 0; i < gwwcnt; i++) {
 				uae_u8 *p = (uae_u8 *)gwwbuf[index][i];
 
@@ -5650,10 +6089,7 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 						int w = (gwwpagesize[index] + state->BytesPerPixel - 1) / state->BytesPerPixel;
 						x = (realoffset % state->BytesPerRow) / state->BytesPerPixel;
 						if (x < pwidth) {
-							copyrow(monid, src + off, dst, x, y, pwidth - x,
-								state->BytesPerRow, state->BytesPerPixel,
-								x, y, vidinfo->rowbytes, vidinfo->pixbytes,
-								vidinfo->picasso_convert, p96_rgbx16);
+							rtg_convert_add(&rtg_convert, x, y, pwidth - x);
 							flushlines++;
 						}
 						w = (gwwpagesize[index] - (state->BytesPerRow - x * state->BytesPerPixel) + state->BytesPerPixel - 1) / state->BytesPerPixel;
@@ -5663,10 +6099,7 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 						y++;
 						while (y < pheight && w > 0) {
 							int maxw = w > pwidth ? pwidth : w;
-							copyrow(monid, src + off, dst, 0, y, maxw,
-								state->BytesPerRow, state->BytesPerPixel,
-								0, y, vidinfo->rowbytes, vidinfo->pixbytes,
-								vidinfo->picasso_convert, p96_rgbx16);
+							rtg_convert_add(&rtg_convert, 0, y, maxw);
 							w -= maxw;
 							y++;
 							flushlines++;
@@ -5679,6 +6112,7 @@ static void picasso_flushpixels(int index, uae_u8 *src, int off, bool render)
 				}
 
 			}
+			rtg_convert_flush(&rtg_convert);
 		}
 		break;
 	}
@@ -6574,6 +7008,8 @@ static void picasso_reset2(int monid)
 			uae_start_thread(_T("rtg"), render_thread, NULL, NULL);
 		}
 	}
+	if (!monid)
+		rtg_convert_init();
 
 	lockrtg();
 
@@ -6614,6 +7050,7 @@ static void picasso_reset(int hardreset)
 
 static void picasso_free(void)
 {
+	rtg_convert_free();
 	if (render_thread_state > 0) {
 		write_comm_pipe_int(render_pipe, -1, 0);
 		while (render_thread_state >= 0) {
@@ -696,6 +696,13 @@ void lockrtg(void);
 void unlockrtg(void);
 
 void fb_copyrow(int monid, uae_u8 *src, uae_u8 *dst, int x, int y, int width, int srcpixbytes, int dy);
+void fb_copyrows(int monid, uae_u8 **src, uae_u8 *dst, int width, int height, int srcpixbytes);
+void copyrows_scale(int monid, uae_u8 *src, uae_u8 *src_screen, uae_u8 *dst,
+	int sx, int sy, int syadd, int rows, int sxadd, int width, int srcbytesperrow, int srcpixbytes,
+	int screenbytesperrow, int screenpixbytes,
+	int dx, int dy, int dstwidth, int dstheight, int dstbytesperrow, int dstpixbytes,
+	bool ck, uae_u32 colorkey,
+	int convert_mode, uae_u32 *p96_rgbx16p, uae_u32 *clut, bool yuv_swap);
 
 extern int p96refresh_active;
 
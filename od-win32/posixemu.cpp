@@ -283,6 +283,10 @@ uae_atomic atomic_dec(volatile uae_atomic *p)
 {
 	return _InterlockedDecrement(p);
 }
+uae_atomic atomic_cmpxchg(volatile uae_atomic *p, uae_u32 v, uae_u32 cmp)
+{
+	return _InterlockedCompareExchange(p, v, cmp);
+}
 
 uae_u32 atomic_bit_test_and_reset(volatile uae_atomic *p, uae_u32 v)
 {
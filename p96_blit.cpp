@@ -1,6 +1,22 @@
 
+#ifndef P96_SIMD_CAT
+#define P96_SIMD_CAT2(a,b) a##b
+#define P96_SIMD_CAT(a,b) P96_SIMD_CAT2(a,b)
+#endif
+
+#if defined(P96_SIMD) && defined(BLT_FUNC_SIMD)
+#ifndef BLT_FUNC_MASK_SIMD
+#define BLT_FUNC_MASK_SIMD BLT_FUNC_SIMD
+#endif
+#define BLT_NAME_C P96_SIMD_CAT(BLT_NAME, _C)
+#define BLT_NAME_MASK_C P96_SIMD_CAT(BLT_NAME_MASK, _C)
+#else
+#define BLT_NAME_C BLT_NAME
+#define BLT_NAME_MASK_C BLT_NAME_MASK
+#endif
+
 #if BLT_SIZE == 3
-static void NOINLINE BLT_NAME(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u32 rgbmask)
+static void NOINLINE BLT_NAME_C(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u32 rgbmask)
 {
 	uae_u8 *src2 = src;
 	uae_u8 *dst2 = dst;
@@ -34,7 +50,7 @@ static void NOINLINE BLT_NAME(unsigned int w, unsigned int h, uae_u8 *src, uae_u
 	}
 }
 #else
-static void NOINLINE BLT_NAME(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u32 rgbmask)
+static void NOINLINE BLT_NAME_C(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u32 rgbmask)
 {
 	uae_u8 *src2 = src;
 	uae_u8 *dst2 = dst;
@@ -127,7 +143,7 @@ static void NOINLINE BLT_NAME(unsigned int w, unsigned int h, uae_u8 *src, uae_u
 #endif
 
 #if BLT_SIZE == 1
-static void NOINLINE BLT_NAME_MASK(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u8 mask)
+static void NOINLINE BLT_NAME_MASK_C(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u8 mask)
 {
 	uae_u8 *src2 = src;
 	uae_u8 *dst2 = dst;
@@ -147,9 +163,64 @@ static void NOINLINE BLT_NAME_MASK(unsigned int w, unsigned int h, uae_u8 *src,
 }
 #endif
 
+#if defined(P96_SIMD) && defined(BLT_FUNC_SIMD)
+/* 16 bytes per step, 24-bit rows in 48 byte steps to stay on pixel boundary. Rest is done by the scalar version. */
+static void NOINLINE BLT_NAME(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u32 rgbmask)
+{
+	const unsigned int step = BLT_SIZE == 3 ? 48 : 16;
+	unsigned int vbytes = (w * BLT_SIZE) / step * step;
+	unsigned int vw = vbytes / BLT_SIZE;
+
+	if (vbytes) {
+		__m128i vrgbmask = _mm_set1_epi32(rgbmask);
+		uae_u8 *src2 = src;
+		uae_u8 *dst2 = dst;
+		for (unsigned int y = 0; y < h; y++) {
+			for (unsigned int x = 0; x < vbytes; x += 16) {
+				__m128i sv = _mm_loadu_si128((__m128i*)(src2 + x));
+				__m128i dv = _mm_loadu_si128((__m128i*)(dst2 + x));
+				_mm_storeu_si128((__m128i*)(dst2 + x), BLT_FUNC_SIMD(sv, dv));
+			}
+			dst2 += dstpitch;
+			src2 += srcpitch;
+		}
+	}
+	if (w > vw)
+		BLT_NAME_C(w - vw, h, src + vbytes, dst + vbytes, srcpitch, dstpitch, rgbmask);
+}
+#if BLT_SIZE == 1
+static void NOINLINE BLT_NAME_MASK(unsigned int w, unsigned int h, uae_u8 *src, uae_u8 *dst, int srcpitch, int dstpitch, uae_u8 mask)
+{
+	unsigned int vw = w & ~15;
+
+	if (vw) {
+		__m128i vmask = _mm_set1_epi8(mask);
+		uae_u8 *src2 = src;
+		uae_u8 *dst2 = dst;
+		for (unsigned int y = 0; y < h; y++) {
+			for (unsigned int x = 0; x < vw; x += 16) {
+				__m128i sv = _mm_loadu_si128((__m128i*)(src2 + x));
+				__m128i dv = _mm_loadu_si128((__m128i*)(dst2 + x));
+				__m128i rv = BLT_FUNC_MASK_SIMD(sv, dv);
+				_mm_storeu_si128((__m128i*)(dst2 + x), _mm_or_si128(_mm_andnot_si128(vmask, dv), _mm_and_si128(rv, vmask)));
+			}
+			dst2 += dstpitch;
+			src2 += srcpitch;
+		}
+	}
+	if (w > vw)
+		BLT_NAME_MASK_C(w - vw, h, src + vw, dst + vw, srcpitch, dstpitch, mask);
+}
+#endif
+#endif
+
 #undef BLT_NAME
 #undef BLT_NAME_MASK
+#undef BLT_NAME_C
+#undef BLT_NAME_MASK_C
 #undef BLT_FUNC
 #undef BLT_FUNC_MASK
+#undef BLT_FUNC_SIMD
+#undef BLT_FUNC_MASK_SIMD
 
 
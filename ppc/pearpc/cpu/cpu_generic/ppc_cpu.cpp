@@ -107,14 +107,58 @@ void PPCCALL ppc_cpu_do_dec(int val)
 static uint ops = 0;
 static int ppc_trace;
 
+/*
+ * Pre-decoded code cache: one slot per instruction word of a 4KB code
+ * page, indexed by the host address of the page. A slot is only used if
+ * the raw word still matches memory, so stores from either CPU never
+ * execute stale decodes. The decrementer is updated once per basic block.
+ */
+#define PPC_CODE_CACHE_PAGES	128
+#define PPC_DEC_BATCH		64
+
+struct ppc_code_entry {
+	uint32 raw;
+	uint32 opc;
+	ppc_opc_function func;
+};
+
+static ppc_code_entry gCodeCache[PPC_CODE_CACHE_PAGES][1024];
+static ppc_code_entry *gCodePage = gCodeCache[0];
+
+static inline ppc_code_entry *ppc_code_cache_page(byte *phys)
+{
+	return gCodeCache[((uintptr_t)phys >> 12) & (PPC_CODE_CACHE_PAGES - 1)];
+}
+
+/* instructions not yet subtracted from the decrementer */
+static uint32 gPendingDec;
+
+/* mfdec/mtdec must see the decrementer up to the current instruction */
+void ppc_cpu_flush_dec(void)
+{
+	if (gPendingDec) {
+		ppc_do_dec(gPendingDec);
+		gPendingDec = 0;
+	}
+}
+
 void PPCCALL ppc_cpu_run_single(int count)
 {
+	ppc_code_entry *e;
+
 	while (count != 0) {
 		if (count > 0)
 			count--;
 		gCPU.npc = gCPU.pc+4;
 		if ((gCPU.pc & ~0xfff) == gCPU.effective_code_page) {
-			gCPU.current_opc = ppc_word_from_BE(*((uint32*)(&gCPU.physical_code_page[gCPU.pc & 0xfff])));
+			uint32 raw = *((uint32*)(&gCPU.physical_code_page[gCPU.pc & 0xfff]));
+			e = &gCodePage[(gCPU.pc & 0xfff) >> 2];
+			if (e->raw != raw || !e->func) {
+				e->raw = raw;
+				e->opc = ppc_word_from_BE(raw);
+				e->func = ppc_dec_resolve(e->opc);
+			}
+			gCPU.current_opc = e->opc;
 			ppc_debug_hook();
 		} else {
 			int ret;
@@ -127,14 +171,19 @@ void PPCCALL ppc_cpu_run_single(int count)
 				}
 			}
 			gCPU.effective_code_page = gCPU.pc & ~0xfff;
+			gCodePage = ppc_code_cache_page(gCPU.physical_code_page);
 			continue;
 		}
 		if (ppc_trace)
 			ht_printf("%08x %04x\n", gCPU.pc, gCPU.current_opc);
-		ppc_exec_opc();
+		e->func();
 		ops++;
 		gCPU.ptb++;
-		ppc_do_dec(1);
+		gPendingDec++;
+		if (gCPU.npc != gCPU.pc + 4 || gPendingDec >= PPC_DEC_BATCH || gCPU.exception_pending) {
+			ppc_do_dec(gPendingDec);
+			gPendingDec = 0;
+		}
 		if ((ops & 0x3ffff)==0) {
 /*			if (pic_check_interrupt()) {
 				gCPU.exception_pending = true;
@@ -217,6 +266,7 @@ void PPCCALL ppc_cpu_run_single(int count)
 		}
 #endif
 	}
+	ppc_cpu_flush_dec();
 }
 
 void PPCCALL ppc_cpu_run_continuous(void)
@@ -348,6 +398,7 @@ bool PPCCALL ppc_cpu_init(uint32 pvr)
 
 void PPCCALL ppc_cpu_free(void)
 {
+	ppc_mmu_tlb_stats();
 	sys_destroy_mutex(exception_mutex);
 }
 
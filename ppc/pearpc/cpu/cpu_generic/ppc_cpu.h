@@ -109,6 +109,7 @@ extern PPC_CPU_State gCPU;
 #include "uae/ppc.h"
 
 void PPCCALL ppc_cpu_atomic_raise_ext_exception();
+void ppc_cpu_flush_dec(void);
 void PPCCALL ppc_cpu_atomic_cancel_ext_exception();
 
 extern uint32 gBreakpoint;
@@ -270,6 +270,7 @@ inline static void ppc_opc_group_2()
 	uint32 ext = PPC_OPC_EXT(gCPU.current_opc);
 	if (ext >= (sizeof ppc_opc_table_group2 / sizeof ppc_opc_table_group2[0])) {
 		ppc_opc_invalid();
+		return;
 	}
 	ppc_opc_table_group2[ext]();
 }
@@ -608,6 +609,20 @@ void FASTCALL ppc_exec_opc()
 	ppc_opc_table_main[mainopc]();
 }
 
+// returns the handler ppc_exec_opc() would end up in, group 31 resolved
+ppc_opc_function ppc_dec_resolve(uint32 opc)
+{
+	uint32 mainopc = PPC_OPC_MAIN(opc);
+	if (mainopc == 31) {
+		uint32 ext = PPC_OPC_EXT(opc);
+		if (ext >= (sizeof ppc_opc_table_group2 / sizeof ppc_opc_table_group2[0])) {
+			return ppc_opc_invalid;
+		}
+		return ppc_opc_table_group2[ext];
+	}
+	return ppc_opc_table_main[mainopc];
+}
+
 void ppc_dec_init()
 {
 	ppc_opc_init_group2();
@@ -28,6 +28,8 @@ void ppc_dec_init();
 
 typedef void (*ppc_opc_function)();
 
+ppc_opc_function ppc_dec_resolve(uint32 opc);
+
 #define PPC_OPC_ASSERT(v)
 
 #define PPC_OPC_MAIN(opc)		(((opc)>>26)&0x3f)
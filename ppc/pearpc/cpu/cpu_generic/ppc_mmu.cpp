@@ -44,7 +44,33 @@ byte *gMemory = NULL;
 uint32 gMemorySize;
 #endif
 
-#undef TLB
+/*
+ * Software TLB: direct-mapped, separate for instruction and data
+ * translations. Entries are tagged with the effective page and the
+ * generation they were filled in, so ppc_mmu_tlb_invalidate() only has
+ * to bump the generation. A data entry filled by a read must take one
+ * miss on the first store so that the changed bit gets set.
+ */
+#define PPC_TLB_ENTRIES 1024
+
+struct ppc_tlb_entry {
+	uint32 ea;
+	uint32 pa;
+	uint32 gen;
+	bool   write;
+	byte  *host;
+};
+
+static ppc_tlb_entry ppc_itlb[PPC_TLB_ENTRIES];
+static ppc_tlb_entry ppc_dtlb[PPC_TLB_ENTRIES];
+static uint32 ppc_tlb_gen = 1;
+static uint64 ppc_tlb_hits, ppc_tlb_misses;
+
+static inline ppc_tlb_entry *ppc_tlb_lookup(uint32 addr, int flags)
+{
+	ppc_tlb_entry *t = (flags & PPC_MMU_CODE) ? ppc_itlb : ppc_dtlb;
+	return &t[(addr >> 12) & (PPC_TLB_ENTRIES - 1)];
+}
 
 static int ppc_pte_protection[] = {
 	// read(0)/write(1) key pp
@@ -70,7 +96,7 @@ static int ppc_pte_protection[] = {
 	0, // r
 };
 
-inline int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &result)
+static inline int ppc_effective_to_physical_walk(uint32 addr, int flags, uint32 &result)
 {
 	static int lastibatcnt;
 	static int lastdbatcnt;
@@ -151,16 +177,6 @@ inline int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &re
 		// FIXME: implement me
 		PPC_MMU_ERR("sr & T\n");
 	} else {
-#ifdef TLB	
-		for (int i=0; i<4; i++) {
-			if ((addr & ~0xfff) == (gCPU.tlb_va[i])) {
-				gCPU.tlb_last = i;
-//				ht_printf("TLB: %d: %08x -> %08x\n", i, addr, gCPU.tlb_pa[i] | (addr & 0xfff));
-				result = gCPU.tlb_pa[i] | (addr & 0xfff);
-				return PPC_MMU_OK;
-			}
-		}
-#endif
 		// page address translation
 		if ((flags & PPC_MMU_CODE) && (sr & SR_N)) {
 			// segment isnt executable
@@ -228,13 +244,6 @@ inline int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &re
 					// ok..
 					uint32 pap = PTE2_RPN(pte);
 					result = pap | offset;
-#ifdef TLB
-					gCPU.tlb_last++;
-					gCPU.tlb_last &= 3;
-					gCPU.tlb_pa[gCPU.tlb_last] = pap;
-					gCPU.tlb_va[gCPU.tlb_last] = addr & ~0xfff;					
-//					ht_printf("TLB: STORE %d: %08x -> %08x\n", gCPU.tlb_last, addr, pap);
-#endif
 					// update access bits
 					uint32 opte = pte;
 					if (flags & PPC_MMU_WRITE) {
@@ -332,9 +341,45 @@ inline int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &re
 	return PPC_MMU_FATAL;
 }
 
+inline int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &result)
+{
+	ppc_tlb_entry *t = ppc_tlb_lookup(addr, flags);
+	int r;
+
+	if (t->gen == ppc_tlb_gen && t->ea == (addr & ~0xfff) && (t->write || !(flags & PPC_MMU_WRITE))) {
+		ppc_tlb_hits++;
+		result = t->pa | (addr & 0xfff);
+		return PPC_MMU_OK;
+	}
+	ppc_tlb_misses++;
+	r = ppc_effective_to_physical_walk(addr, flags, result);
+	if (r == PPC_MMU_OK) {
+		t->ea = addr & ~0xfff;
+		t->pa = result & ~0xfff;
+		t->gen = ppc_tlb_gen;
+		t->write = (flags & PPC_MMU_WRITE) != 0;
+		t->host = NULL;
+	}
+	return r;
+}
+
 void ppc_mmu_tlb_invalidate()
 {
 	gCPU.effective_code_page = 0xffffffff;
+	ppc_tlb_gen++;
+	if (ppc_tlb_gen == 0) {
+		memset(ppc_itlb, 0, sizeof ppc_itlb);
+		memset(ppc_dtlb, 0, sizeof ppc_dtlb);
+		ppc_tlb_gen = 1;
+	}
+}
+
+void ppc_mmu_tlb_stats()
+{
+	uint64 total = ppc_tlb_hits + ppc_tlb_misses;
+	ht_printf("[PPC/MMU] TLB: %llu hits, %llu misses (%u%%)\n",
+		ppc_tlb_hits, ppc_tlb_misses, total ? (uint)(ppc_tlb_hits * 100 / total) : 0);
+	ppc_tlb_hits = ppc_tlb_misses = 0;
 }
 
 /*
@@ -372,6 +417,7 @@ bool FASTCALL ppc_mmu_set_sdr1(uint32 newval, bool quiesce)
 	gCPU.pagetable_base = htaborg<<16;
 	gCPU.sdr1 = newval;
 	gCPU.pagetable_hashmask = ((xx<<10)|0x3ff);
+	ppc_mmu_tlb_invalidate();
 	PPC_MMU_TRACE("new pagetable: sdr1 accepted\n");
 	PPC_MMU_TRACE("number of pages: 2^%d pagetable_start: 0x%08x size: 2^%d\n", n+13, gCPU.pagetable_base, n+16);
 #if 0
@@ -444,10 +490,19 @@ int FASTCALL ppc_direct_effective_memory_handle(uint32 addr, byte *&ptr)
 
 int FASTCALL ppc_direct_effective_memory_handle_code(uint32 addr, byte *&ptr)
 {
+	ppc_tlb_entry *t = ppc_tlb_lookup(addr, PPC_MMU_CODE);
 	uint32 ea;
 	int r;
+	if (t->host && t->gen == ppc_tlb_gen && t->ea == (addr & ~0xfff)) {
+		ppc_tlb_hits++;
+		ptr = t->host + (addr & 0xfff);
+		return PPC_MMU_OK;
+	}
 	if (!((r = ppc_effective_to_physical(addr, PPC_MMU_READ | PPC_MMU_CODE, ea)))) {
-		return ppc_direct_physical_memory_handle(ea, ptr);
+		r = ppc_direct_physical_memory_handle(ea, ptr);
+		if (r == PPC_MMU_OK && ptr && t->gen == ppc_tlb_gen && t->ea == (addr & ~0xfff)) {
+			t->host = ptr - (addr & 0xfff);
+		}
 	}
 	return r;
 }
@@ -40,6 +40,7 @@ extern uint32 gMemorySize;
 int FASTCALL ppc_effective_to_physical(uint32 addr, int flags, uint32 &result);
 bool FASTCALL ppc_mmu_set_sdr1(uint32 newval, bool quiesce);
 void ppc_mmu_tlb_invalidate();
+void ppc_mmu_tlb_stats();
 
 int FASTCALL ppc_read_physical_dword(uint32 addr, uint64 &result);
 int FASTCALL ppc_read_physical_word(uint32 addr, uint32 &result);
@@ -350,6 +350,7 @@ void ppc_opc_mfspr()
 		case 18: gCPU.gpr[rD] = gCPU.dsisr; return;
 		case 19: gCPU.gpr[rD] = gCPU.dar; return;
 		case 22: {
+			ppc_cpu_flush_dec();
 			gCPU.dec = gCPU.pdec / TB_TO_PTB_FACTOR;
 			gCPU.gpr[rD] = gCPU.dec;
 			return;
@@ -665,6 +666,7 @@ void ppc_opc_mtspr()
 /*		case 18: gCPU.gpr[rD] = gCPU.dsisr; return;
 		case 19: gCPU.gpr[rD] = gCPU.dar; return;*/
 		case 22: {
+			ppc_cpu_flush_dec();
 			gCPU.dec = gCPU.gpr[rS];
 			gCPU.pdec = gCPU.dec;
 			//ht_printf("pdec = %llx %08x\n", gCPU.pdec, gCPU.pc);
@@ -692,6 +694,8 @@ void ppc_opc_mtspr()
 		}
 		break;
 	case 16:
+		// BAT change
+		ppc_mmu_tlb_invalidate();
 		switch (spr1) {
 		case 16:
 			gCPU.ibatu[0] = gCPU.gpr[rS];
@@ -806,6 +810,7 @@ void ppc_opc_mtsr()
 	PPC_OPC_TEMPL_X(gCPU.current_opc, rS, SR, rB);
 	// FIXME: check insn
 	gCPU.sr[SR & 0xf] = gCPU.gpr[rS];
+	ppc_mmu_tlb_invalidate();
 }
 /*
  *	mtsrin		Move to Segment Register Indirect
@@ -821,6 +826,7 @@ void ppc_opc_mtsrin()
 	PPC_OPC_TEMPL_X(gCPU.current_opc, rS, rA, rB);
 	// FIXME: check insn
 	gCPU.sr[gCPU.gpr[rB] >> 28] = gCPU.gpr[rS];
+	ppc_mmu_tlb_invalidate();
 }
 
 /*
@@ -115,6 +115,143 @@ static bool ppc_init_done;
 static int ppc_implementation;
 static bool ppc_paused;
 
+/*
+ * PPC I/O. Banks flagged ABFLAG_THREADSAFE (RAM) are accessed directly
+ * from the PPC thread. Everything else is posted to a single-slot
+ * mailbox that the emulation thread services at event boundaries
+ * (uae_ppc_execute_check/quick). If the emulation thread has released
+ * the spinlock, the PPC thread withdraws the request and does the
+ * access itself.
+ */
+
+enum {
+	PPC_IO_FREE,
+	PPC_IO_POSTED,
+	PPC_IO_BUSY,
+	PPC_IO_DONE
+};
+
+struct ppc_io_request
+{
+	volatile uae_atomic state;
+	uae_u32 addr;
+	uae_u64 data;
+	int size;
+	bool write;
+};
+
+static struct ppc_io_request ppc_io;
+static volatile bool ppc_io_waiting;
+static uae_sem_t ppc_io_sem;
+static uae_u32 ppc_io_lockfree, ppc_io_mailbox, ppc_io_direct, ppc_io_waits;
+
+static bool ppc_io_trylock(void)
+{
+#ifdef WIN32_SPINLOCK
+	return TryEnterCriticalSection(&ppc_cs1) != 0;
+#else
+	return g_mutex_trylock(&mutex) != 0;
+#endif
+}
+
+static void ppc_io_access(struct ppc_io_request *r)
+{
+	uaecptr addr = r->addr;
+	switch (r->size)
+	{
+	case 8:
+		if (r->write) {
+			put_long(addr + 0, (uae_u32)(r->data >> 32));
+			put_long(addr + 4, (uae_u32)r->data);
+		} else {
+			uae_u32 v1 = get_long(addr + 0);
+			uae_u32 v2 = get_long(addr + 4);
+			r->data = ((uae_u64)v1 << 32) | v2;
+		}
+		break;
+	case 4:
+		if (r->write)
+			put_long(addr, (uae_u32)r->data);
+		else
+			r->data = get_long(addr);
+		break;
+	case 2:
+		if (r->write)
+			put_word(addr, (uae_u32)r->data);
+		else
+			r->data = get_word(addr);
+		break;
+	case 1:
+		if (r->write)
+			put_byte(addr, (uae_u32)r->data);
+		else
+			r->data = get_byte(addr);
+		break;
+	}
+}
+
+// emulation thread, spinlock held
+static void ppc_io_service(void)
+{
+	if (ppc_io.state != PPC_IO_POSTED)
+		return;
+	if (atomic_cmpxchg(&ppc_io.state, PPC_IO_BUSY, PPC_IO_POSTED) != PPC_IO_POSTED)
+		return;
+	ppc_io_access(&ppc_io);
+	ppc_io_mailbox++;
+	// PPC thread continues as soon as state is DONE
+	ppc_io_waiting = false;
+	ppc_io.state = PPC_IO_DONE;
+	uae_sem_post(&ppc_io_sem);
+}
+
+// PPC thread
+static uae_u64 ppc_io_do(uae_u32 addr, uae_u64 data, int size, bool write)
+{
+	addrbank *ab = &get_mem_bank(addr);
+
+	if (ab->flags & ABFLAG_THREADSAFE) {
+		struct ppc_io_request r;
+		r.addr = addr;
+		r.data = data;
+		r.size = size;
+		r.write = write;
+		ppc_io_access(&r);
+		ppc_io_lockfree++;
+		return r.data;
+	}
+
+	if (!ppc_io_sem)
+		uae_sem_init(&ppc_io_sem, 0, 0);
+	ppc_io.addr = addr;
+	ppc_io.data = data;
+	ppc_io.size = size;
+	ppc_io.write = write;
+	ppc_io_waiting = true;
+	atomic_inc(&ppc_io.state);
+	sleep_cpu_wakeup();
+	while (ppc_io.state != PPC_IO_DONE) {
+		if (ppc_io_trylock()) {
+			if (atomic_cmpxchg(&ppc_io.state, PPC_IO_BUSY, PPC_IO_POSTED) == PPC_IO_POSTED) {
+				ppc_io_access(&ppc_io);
+				ppc_io_direct++;
+				ppc_io_waiting = false;
+				ppc_io.state = PPC_IO_DONE;
+			}
+			uae_ppc_spinlock_release();
+			continue;
+		}
+		// posted when serviced, timeout retries the spinlock in case
+		// the emulation thread released it without servicing
+		ppc_io_waits++;
+		uae_sem_trywait_delay(&ppc_io_sem, 1);
+	}
+	data = ppc_io.data;
+	ppc_io_waiting = false;
+	ppc_io.state = PPC_IO_FREE;
+	return data;
+}
+
 #define CSPPC_PVR 0x00090204
 #define BLIZZPPC_PVR 0x00070101
 
@@ -337,7 +474,7 @@ static PPCLockStatus get_ppc_lock(PPCLockMethod method)
 
 		bool trylock_called = false;
 		while (true) {
-			if (ppc_spinlock_waiting) {
+			if (ppc_spinlock_waiting || (ppc_io_waiting && ppc_io.state != PPC_IO_DONE)) {
 				/* PPC CPU is waiting for the spinlock and the UAE side
 				 * owns the spinlock - no additional locking needed */
 				if (trylock_called) {
@@ -624,6 +761,7 @@ static void ppc_thread(void *v)
 
 void uae_ppc_execute_check(void)
 {
+	ppc_io_service();
 	if (ppc_spinlock_waiting) {
 		uae_ppc_spinlock_release();
 		uae_ppc_spinlock_get();
@@ -632,6 +770,7 @@ void uae_ppc_execute_check(void)
 
 void uae_ppc_execute_quick()
 {
+	ppc_io_service();
 	uae_ppc_spinlock_release();
 	sleep_millis_main(1);
 	uae_ppc_spinlock_get();
@@ -654,27 +793,8 @@ bool uae_ppc_direct_physical_memory_handle(uint32_t addr, uint8_t *&ptr)
 	return true;
 }
 
-STATIC_INLINE bool spinlock_pre(uaecptr addr)
-{
-	addrbank *ab = &get_mem_bank(addr);
-	if ((ab->flags & ABFLAG_THREADSAFE) == 0) {
-		sleep_cpu_wakeup();
-		uae_ppc_spinlock_get();
-		return true;
-	}
-	return false;
-}
-
-STATIC_INLINE void spinlock_post(bool locked)
-{
-	if (locked)
-		uae_ppc_spinlock_release();
-}
-
 bool UAECALL uae_ppc_io_mem_write(uint32_t addr, uint32_t data, int size)
 {
-	bool locked = false;
-
 	while (ppc_thread_running && ppc_cpu_lock_state < 0 && ppc_state);
 
 #if PPC_ACCESS_LOG > 0 && PPC_ACCESS_LOG < 2
@@ -684,19 +804,7 @@ bool UAECALL uae_ppc_io_mem_write(uint32_t addr, uint32_t data, int size)
 	}
 #endif
 
-	locked = spinlock_pre(addr);
-	switch (size)
-	{
-	case 4:
-		put_long(addr, data);
-		break;
-	case 2:
-		put_word(addr, data);
-		break;
-	case 1:
-		put_byte(addr, data);
-		break;
-	}
+	ppc_io_do(addr, data, size, true);
 
 	if (addr >= 0xdff000 && addr < 0xe00000) {
 		int reg = addr & 0x1fe;
@@ -712,8 +820,6 @@ bool UAECALL uae_ppc_io_mem_write(uint32_t addr, uint32_t data, int size)
 		}
 	}
 
-	spinlock_post(locked);
-
 #if PPC_ACCESS_LOG >= 2
 	write_log(_T("PPC write %08x = %08x %d\n"), addr, data, size);
 #endif
@@ -724,7 +830,6 @@ bool UAECALL uae_ppc_io_mem_write(uint32_t addr, uint32_t data, int size)
 bool UAECALL uae_ppc_io_mem_read(uint32_t addr, uint32_t *data, int size)
 {
 	uint32_t v;
-	bool locked = false;
 
 	while (ppc_thread_running && ppc_cpu_lock_state < 0 && ppc_state);
 
@@ -741,21 +846,8 @@ bool UAECALL uae_ppc_io_mem_read(uint32_t addr, uint32_t *data, int size)
 		}
 	}
 
-	locked = spinlock_pre(addr);
-	switch (size)
-	{
-	case 4:
-		v = get_long(addr);
-		break;
-	case 2:
-		v = get_word(addr);
-		break;
-	case 1:
-		v = get_byte(addr);
-		break;
-	}
+	v = (uint32_t)ppc_io_do(addr, 0, size, false);
 	*data = v;
-	spinlock_post(locked);
 
 #if PPC_ACCESS_LOG > 0 && PPC_ACCESS_LOG < 2
 	if (!valid_address(addr, size)) {
@@ -772,14 +864,9 @@ bool UAECALL uae_ppc_io_mem_read(uint32_t addr, uint32_t *data, int size)
 
 bool UAECALL uae_ppc_io_mem_write64(uint32_t addr, uint64_t data)
 {
-	bool locked = false;
-
 	while (ppc_thread_running && ppc_cpu_lock_state < 0 && ppc_state);
 
-	locked = spinlock_pre(addr);
-	put_long(addr + 0, data >> 32);
-	put_long(addr + 4, data & 0xffffffff);
-	spinlock_post(locked);
+	ppc_io_do(addr, data, 8, true);
 
 #if PPC_ACCESS_LOG >= 2
 	write_log(_T("PPC mem write64 %08x = %08llx\n"), addr, data);
@@ -790,16 +877,9 @@ bool UAECALL uae_ppc_io_mem_write64(uint32_t addr, uint64_t data)
 
 bool UAECALL uae_ppc_io_mem_read64(uint32_t addr, uint64_t *data)
 {
-	bool locked = false;
-	uint32_t v1, v2;
-
 	while (ppc_thread_running && ppc_cpu_lock_state < 0 && ppc_state);
 
-	locked = spinlock_pre(addr);
-	v1 = get_long(addr + 0);
-	v2 = get_long(addr + 4);
-	*data = ((uint64_t)v1 << 32) | v2;
-	spinlock_post(locked);
+	*data = ppc_io_do(addr, 0, 8, false);
 
 #if PPC_ACCESS_LOG >= 2
 	write_log(_T("PPC mem read64 %08x = %08llx\n"), addr, *data);
@@ -838,12 +918,16 @@ void uae_ppc_cpu_stop(void)
 			impl.stop();
 			while (ppc_state != PPC_STATE_STOP && ppc_state != PPC_STATE_CRASH) {
 				uae_ppc_wakeup();
+				ppc_io_service();
 				uae_ppc_spinlock_release();
 				uae_ppc_spinlock_get();
 			}
 			write_log(_T("PPC: Stopped\n"));
 		}
 	}
+	write_log(_T("PPC: I/O %u lock-free, %u mailbox, %u direct, %u waits\n"),
+		ppc_io_lockfree, ppc_io_mailbox, ppc_io_direct, ppc_io_waits);
+	ppc_io_lockfree = ppc_io_mailbox = ppc_io_direct = ppc_io_waits = 0;
 	ppc_state = PPC_STATE_INACTIVE;
 }
 
@@ -897,6 +981,7 @@ void uae_ppc_free(void)
 	uae_ppc_cpu_stop();
 	if (wasactive && impl.map_memory)
 		impl.map_memory(NULL, 0);
+	uae_sem_destroy(&ppc_io_sem);
 }
 
 void uae_ppc_cpu_lock(void)
@@ -36,6 +36,11 @@
 #include "qemuuaeglue.h"
 #endif
 
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(_M_ARM64EC)
+#define CIRRUS_SIMD 1
+#include <emmintrin.h>
+#endif
+
 /*
  * TODO:
  *    - destination write mask support not complete (bits 5..7)
@@ -292,6 +297,7 @@ static void cirrus_bitblt_fill_nop(CirrusVGAState *s,
 
 #define ROP_NAME src
 #define ROP_FN(d, s) s
+#define ROP_COPY 1
 #include "cirrus_vga_rop.h"
 
 #define ROP_NAME 1
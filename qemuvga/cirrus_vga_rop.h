@@ -53,6 +53,23 @@ glue(cirrus_bitblt_rop_fwd_, ROP_NAME)(CirrusVGAState *s,
 
 	BLTCHECK_FWD
 
+#ifdef ROP_COPY
+    /* memmove only when it gives the same result, dst inside the row ahead of src smears like the hardware */
+    for (y = 0; y < bltheight; y++) {
+        if (dst <= src || dst >= src + bltwidth) {
+            memmove(dst, src, bltwidth);
+        } else {
+            for (x = 0; x < (bltwidth & ~3); x += 4)
+                ROP_OP_32((uint32_t*)(dst + x), *((uint32_t*)(src + x)));
+            for (; x < bltwidth; x++)
+                ROP_OP(dst + x, src[x]);
+        }
+        dst += dstpitch;
+        src += srcpitch;
+    }
+    return;
+#endif
+
     dstpitch -= bltwidth;
     srcpitch -= bltwidth;
 
@@ -83,6 +100,23 @@ glue(cirrus_bitblt_rop_bkwd_, ROP_NAME)(CirrusVGAState *s,
 	
 	int x,y;
 
+#ifdef ROP_COPY
+    /* dst and src point to the last byte of the row, same memmove rule as above mirrored */
+    for (y = 0; y < bltheight; y++) {
+        if (dst >= src || dst <= src - bltwidth) {
+            memmove(dst - bltwidth + 1, src - bltwidth + 1, bltwidth);
+        } else {
+            for (x = 0; x < (bltwidth & ~3); x += 4)
+                ROP_OP_32((uint32_t*)(dst - x - 3), *((uint32_t*)(src - x - 3)));
+            for (; x < bltwidth; x++)
+                ROP_OP(dst - x, src[-x]);
+        }
+        dst += dstpitch;
+        src += srcpitch;
+    }
+    return;
+#endif
+
 	dstpitch += bltwidth;
     srcpitch += bltwidth;
 
@@ -120,7 +154,21 @@ glue(glue(cirrus_bitblt_rop_fwd_transp_, ROP_NAME),_8)(CirrusVGAState *s,
     srcpitch -= bltwidth;
     
 	for (y = 0; y < bltheight; y++) {
-        for (x = 0; x < bltwidth; x++) {
+        x = 0;
+#if defined(ROP_COPY) && defined(CIRRUS_SIMD)
+        {
+            __m128i key = _mm_set1_epi8(s->vga.gr[0x34]);
+            for (; x < (bltwidth & ~15); x += 16) {
+                __m128i sv = _mm_loadu_si128((const __m128i*)src);
+                __m128i dv = _mm_loadu_si128((const __m128i*)dst);
+                __m128i m = _mm_cmpeq_epi8(sv, key);
+                _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(m, dv), _mm_andnot_si128(m, sv)));
+                dst += 16;
+                src += 16;
+            }
+        }
+#endif
+        for (; x < bltwidth; x++) {
 	    p = *dst;
             ROP_OP(&p, *src);
 	    if (p != s->vga.gr[0x34]) *dst = p;
@@ -176,7 +224,21 @@ glue(glue(cirrus_bitblt_rop_fwd_transp_, ROP_NAME),_16)(CirrusVGAState *s,
     srcpitch -= bltwidth;
 
 	for (y = 0; y < bltheight; y++) {
-        for (x = 0; x < bltwidth; x+=2) {
+        x = 0;
+#if defined(ROP_COPY) && defined(CIRRUS_SIMD)
+        {
+            __m128i key = _mm_set1_epi16((short)(s->vga.gr[0x34] | (s->vga.gr[0x35] << 8)));
+            for (; x < (bltwidth & ~15); x += 16) {
+                __m128i sv = _mm_loadu_si128((const __m128i*)src);
+                __m128i dv = _mm_loadu_si128((const __m128i*)dst);
+                __m128i m = _mm_cmpeq_epi16(sv, key);
+                _mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(m, dv), _mm_andnot_si128(m, sv)));
+                dst += 16;
+                src += 16;
+            }
+        }
+#endif
+        for (; x < bltwidth; x+=2) {
 	    p1 = *dst;
 	    p2 = *(dst+1);
             ROP_OP(&p1, *src);
@@ -239,6 +301,7 @@ glue(glue(cirrus_bitblt_rop_bkwd_transp_, ROP_NAME),_16)(CirrusVGAState *s,
 #include "cirrus_vga_rop2.h"
 
 #undef ROP_NAME
+#undef ROP_COPY
 #undef ROP_OP
 #undef ROP_OP_16
 #undef ROP_OP_32
@@ -65,6 +65,22 @@ glue(glue(glue(cirrus_patternfill_, ROP_NAME), _),DEPTH)
     pattern_pitch = 32;
 #endif
     pattern_y = s->cirrus_blt_srcaddr & 7;
+#if defined(ROP_COPY) && DEPTH != 24
+    /* PATCOPY: each row is its pattern line repeated, pattern_x is a byte offset */
+    for(y = 0; y < bltheight; y++) {
+        src1 = src + pattern_y * pattern_pitch;
+        for (x = skipleft; x < bltwidth; ) {
+            int n = pattern_pitch - (x & (pattern_pitch - 1));
+            if (n > bltwidth - x)
+                n = bltwidth - x;
+            memcpy(dst + x, src1 + (x & (pattern_pitch - 1)), n);
+            x += n;
+        }
+        pattern_y = (pattern_y + 1) & 7;
+        dst += dstpitch;
+    }
+    return;
+#endif
     for(y = 0; y < bltheight; y++) {
         pattern_x = skipleft;
         d = dst + skipleft;
@@ -293,6 +309,34 @@ glue(glue(glue(cirrus_fill_, ROP_NAME), _),DEPTH)
 	col = s->cirrus_blt_fgcol;
 
     d1 = dst;
+#if defined(ROP_COPY) && DEPTH == 8
+    for(y = 0; y < bltheight; y++) {
+        memset(d1, col, bltwidth);
+        d1 += dstpitch;
+    }
+    return;
+#elif defined(ROP_COPY) && defined(CIRRUS_SIMD) && DEPTH != 24
+    {
+#if DEPTH == 16
+        __m128i vcol = _mm_set1_epi16((short)col);
+#else
+        __m128i vcol = _mm_set1_epi32(col);
+#endif
+        for(y = 0; y < bltheight; y++) {
+            d = d1;
+            for(x = 0; x < (bltwidth & ~15); x += 16) {
+                _mm_storeu_si128((__m128i*)d, vcol);
+                d += 16;
+            }
+            for(; x < bltwidth; x += (DEPTH / 8)) {
+                PUTPIXEL();
+                d += (DEPTH / 8);
+            }
+            d1 += dstpitch;
+        }
+        return;
+    }
+#endif
     for(y = 0; y < bltheight; y++) {
         d = d1;
         for(x = 0; x < bltwidth; x += (DEPTH / 8)) {
@@ -1936,8 +1936,8 @@ static void vga_draw_graphic(VGACommonState *s, int full_update)
 	// video window (overlay)
 	if ((s->cr[0x3e] & 1) && bits >= 8) {
 
-		void copyrow_scale(int monid, uint8_t *src, uint8_t *src_screen, uint8_t *dst,
-			int sx, int sy, int sxadd, int width, int srcbytesperrow, int srcpixbytes,
+		void copyrows_scale(int monid, uint8_t *src, uint8_t *src_screen, uint8_t *dst,
+			int sx, int sy, int syadd, int rows, int sxadd, int width, int srcbytesperrow, int srcpixbytes,
 			int screenbytesperrow, int screenpixbytes,
 			int dx, int dy, int dstwidth, int dstheight, int dstbytesperrow, int dstpixbytes,
 			bool ck, uint32_t colorkey,
@@ -2019,22 +2019,24 @@ static void vga_draw_graphic(VGACommonState *s, int full_update)
 			vzoom = 256;
 
 		int y = 0;
+		int rows = 0;
 		for (int oy = 0; oy < vertical_height; oy++) {
 			if (vptr + (y >> 8) * bytesperrow > s->vram_size)
 				break;
-			if (s->start_addr * 4 + wvs * line_offset > s->vram_size)
+			if (s->start_addr * 4 + (wvs + rows) * line_offset > s->vram_size)
 				break;
-			if (d2 + wvs * linesize > s->vram_ptr + s->vram_size)
+			if (d2 + (wvs + rows) * linesize > s->vram_ptr + s->vram_size)
 				break;
-			copyrow_scale(s->monid, s->vram_ptr + vptr, s->vram_ptr + s->start_addr * 4, d2,
-				0, y >> 8, hzoom, overlay_width, bytesperrow, overlaybpp,
-				line_offset, bits / 8,
-				region1size, wvs, width, height, linesize, outbpp,
-				occlusion, colorkey,
-				convert, s->cirrus_rgbx16, s->last_palette, false);
-			wvs++;
+			rows++;
 			y += vzoom;
 		}
+		copyrows_scale(s->monid, s->vram_ptr + vptr, s->vram_ptr + s->start_addr * 4, d2,
+			0, 0, vzoom, rows, hzoom, overlay_width, bytesperrow, overlaybpp,
+			line_offset, bits / 8,
+			region1size, wvs, width, height, linesize, outbpp,
+			occlusion, colorkey,
+			convert, s->cirrus_rgbx16, s->last_palette, false);
+		wvs += rows;
 
 		s->ovl_changed = 1;
 		s->old_overlay = 1;
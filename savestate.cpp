@@ -64,6 +64,7 @@
 #include "inputrecord.h"
 #include "disk.h"
 #include "threaddep/thread.h"
+#include "uae/time.h"
 #include "a2091.h"
 #include "devices.h"
 #include "fsdb.h"
@@ -374,6 +375,191 @@ TCHAR *restore_path_full_func(uae_u8 **dstp)
 }
 
 
+/* RAM chunks are split into independent zlib blocks (chunk flag 2) so that
+   they can be packed and unpacked by multiple threads. All-zero blocks are
+   not stored at all, incompressible blocks are stored as is. */
+
+#define SAVESTATE_PACK_BLOCK (256 * 1024)
+#define SAVESTATE_PACK_MIN (1024 * 1024)
+#define SAVESTATE_PACK_THREADS 8
+#define SAVESTATE_PACK_LEVEL 1
+
+struct packblock
+{
+	uae_u8 *raw;
+	int rawlen;
+	uae_u8 *data;
+	int datalen;
+	bool owned;
+	bool failed;
+};
+
+struct packjob
+{
+	struct packblock *blocks;
+	int count;
+	bool unpack;
+	volatile uae_atomic next;
+};
+
+static bool savestate_iszero(const uae_u8 *p, int len)
+{
+	const uae_u32 *p32 = (const uae_u32*)p;
+	for (int i = 0; i < len / 4; i++) {
+		if (p32[i])
+			return false;
+	}
+	for (int i = len & ~3; i < len; i++) {
+		if (p[i])
+			return false;
+	}
+	return true;
+}
+
+static void savestate_pack_block(struct packblock *b)
+{
+	int bound, v;
+
+	b->owned = false;
+	if (savestate_iszero(b->raw, b->rawlen)) {
+		b->data = NULL;
+		b->datalen = 0;
+		return;
+	}
+	bound = zfile_zcompress_bound(b->rawlen);
+	b->data = xmalloc(uae_u8, bound);
+	v = b->data ? zfile_zcompress_mem(b->data, bound, b->raw, b->rawlen, SAVESTATE_PACK_LEVEL) : 0;
+	if (v <= 0 || v >= b->rawlen) {
+		xfree(b->data);
+		b->data = b->raw;
+		b->datalen = b->rawlen;
+		return;
+	}
+	b->datalen = v;
+	b->owned = true;
+}
+
+static void savestate_unpack_block(struct packblock *b)
+{
+	if (b->datalen == 0) {
+		memset(b->raw, 0, b->rawlen);
+	} else if (b->datalen == b->rawlen) {
+		memcpy(b->raw, b->data, b->rawlen);
+	} else if (zfile_zuncompress_mem(b->raw, b->rawlen, b->data, b->datalen) != b->rawlen) {
+		memset(b->raw, 0, b->rawlen);
+		b->failed = true;
+	}
+}
+
+static void savestate_pack_thread(void *v)
+{
+	struct packjob *j = (struct packjob*)v;
+	for (;;) {
+		int i = atomic_inc(&j->next) - 1;
+		if (i >= j->count)
+			break;
+		if (j->unpack)
+			savestate_unpack_block(&j->blocks[i]);
+		else
+			savestate_pack_block(&j->blocks[i]);
+	}
+}
+
+static int savestate_pack_threads(void)
+{
+	int cpus;
+#ifdef _WIN32
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	cpus = si.dwNumberOfProcessors;
+#else
+	cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (cpus < 1)
+		cpus = 1;
+	if (cpus > SAVESTATE_PACK_THREADS)
+		cpus = SAVESTATE_PACK_THREADS;
+	return cpus;
+}
+
+static void savestate_pack_run(struct packblock *blocks, int count, bool unpack)
+{
+	uae_thread_id tids[SAVESTATE_PACK_THREADS];
+	struct packjob job;
+	int threads, started = 0;
+
+	job.blocks = blocks;
+	job.count = count;
+	job.unpack = unpack;
+	job.next = 0;
+	threads = savestate_pack_threads();
+	if (threads > count)
+		threads = count;
+	/* calling thread is one of the workers */
+	for (int i = 1; i < threads; i++) {
+		if (uae_start_thread(NULL, savestate_pack_thread, &job, &tids[started]))
+			started++;
+	}
+	savestate_pack_thread(&job);
+	for (int i = 0; i < started; i++)
+		uae_wait_thread(tids[i]);
+}
+
+static bool restore_packed(struct zfile *f, uae_u8 *memory, int fullsize, int size)
+{
+	uae_u8 tmp[8], *src, *table, *data;
+	struct packblock *blocks;
+	int blocksize, count, offset, datalen;
+	bool ok = true;
+
+	if (size < 8 || zfile_fread(tmp, 1, 8, f) != 8)
+		return false;
+	src = tmp;
+	blocksize = restore_u32();
+	count = restore_u32();
+	size -= 8;
+	if (blocksize <= 0 || count < 0 || count > size / 4 || (uae_s64)count * blocksize < fullsize)
+		return false;
+	table = xmalloc(uae_u8, count * 4 + 1);
+	datalen = size - count * 4;
+	data = xmalloc(uae_u8, datalen + 1);
+	blocks = xcalloc(struct packblock, count + 1);
+	if (!table || !data || !blocks) {
+		ok = false;
+		goto end;
+	}
+	zfile_fread(table, 1, count * 4, f);
+	zfile_fread(data, 1, datalen, f);
+	src = table;
+	offset = 0;
+	for (int i = 0; i < count; i++) {
+		struct packblock *b = &blocks[i];
+		b->raw = memory + (uae_s64)i * blocksize;
+		b->rawlen = fullsize - i * blocksize;
+		if (b->rawlen > blocksize)
+			b->rawlen = blocksize;
+		if (b->rawlen < 0)
+			b->rawlen = 0;
+		b->datalen = restore_u32();
+		b->data = data + offset;
+		offset += b->datalen;
+		if (b->datalen < 0 || offset > datalen || b->datalen > b->rawlen) {
+			ok = false;
+			goto end;
+		}
+	}
+	savestate_pack_run(blocks, count, true);
+	for (int i = 0; i < count; i++) {
+		if (blocks[i].failed)
+			ok = false;
+	}
+end:
+	xfree(blocks);
+	xfree(data);
+	xfree(table);
+	return ok;
+}
+
 /* read and write IFF-style hunks */
 
 static void save_chunk (struct zfile *f, uae_u8 *chunk, size_t len, const TCHAR *name, int compress)
@@ -512,7 +698,11 @@ static uae_u8 *restore_chunk (struct zfile *f, TCHAR *name, unsigned int *len, u
 		mem = xcalloc (uae_u8, *totallen + 100);
 		if (!mem)
 			return NULL;
-		if (flags & 1) {
+		if (flags & 2) {
+			size_t pos = zfile_ftell(f);
+			restore_packed(f, mem, *totallen, len2);
+			zfile_fseek(f, pos + len2, SEEK_SET);
+		} else if (flags & 1) {
 			zfile_zuncompress (mem, *totallen, f, len2);
 		} else {
 			zfile_fread (mem, 1, len2, f);
@@ -548,7 +738,14 @@ void restore_ram (size_t filepos, uae_u8 *memory)
 		src = tmp;
 		fullsize = restore_u32 ();
 		size -= 4;
-		zfile_zuncompress (memory, fullsize, savestate_file, size);
+		if (flags & 2) {
+			frame_time_t t = read_processor_time();
+			if (!restore_packed(savestate_file, memory, fullsize, size))
+				write_log(_T("STATERESTORE: corrupted RAM chunk at %u\n"), filepos);
+			write_log(_T("RAM chunk %u bytes restored in %d ms\n"), fullsize, (int)((read_processor_time() - t) * 1000 / syncbase));
+		} else {
+			zfile_zuncompress (memory, fullsize, savestate_file, size);
+		}
 	} else {
 		zfile_fread (memory, 1, size, savestate_file);
 	}
@@ -895,37 +1092,143 @@ void savestate_initsave (const TCHAR *filename, int mode, int nodialogs, bool sa
 	}
 }
 
+struct saveram
+{
+	const TCHAR *name;
+	uae_u8 *mem;
+	size_t len;
+	struct packblock *blocks;
+	int count;
+};
+
+static int save_ram_add(struct saveram *r, int cnt, uae_u8 *mem, size_t len, const TCHAR *name)
+{
+	if (!mem)
+		return cnt;
+	r[cnt].name = name;
+	r[cnt].mem = mem;
+	r[cnt].len = len;
+	r[cnt].blocks = NULL;
+	r[cnt].count = 0;
+	return cnt + 1;
+}
+
+static void save_chunk_packed(struct zfile *f, struct saveram *r)
+{
+	uae_u8 tmp[4 * 4], *dst;
+	size_t len;
+	char *s;
+
+	len = 4 + 4 + r->count * 4;
+	for (int i = 0; i < r->count; i++)
+		len += r->blocks[i].datalen;
+	s = ua(r->name);
+	zfile_fwrite(s, 1, 4, f);
+	xfree(s);
+	dst = &tmp[0];
+	save_u32t(len + 4 + 4 + 4 + 4);
+	save_u32(1 | 2);
+	save_u32t(r->len);
+	save_u32(SAVESTATE_PACK_BLOCK);
+	zfile_fwrite(&tmp[0], 1, dst - tmp, f);
+	dst = &tmp[0];
+	save_u32(r->count);
+	zfile_fwrite(&tmp[0], 1, 4, f);
+	for (int i = 0; i < r->count; i++) {
+		dst = &tmp[0];
+		save_u32(r->blocks[i].datalen);
+		zfile_fwrite(&tmp[0], 1, 4, f);
+	}
+	for (int i = 0; i < r->count; i++) {
+		struct packblock *b = &r->blocks[i];
+		if (b->datalen)
+			zfile_fwrite(b->data, 1, b->datalen, f);
+	}
+	/* alignment */
+	len = 4 - (len & 3);
+	if (len) {
+		uae_u8 zero[4] = { 0, 0, 0, 0 };
+		zfile_fwrite(zero, 1, len, f);
+	}
+	write_log(_T("Chunk '%s' size %u packed %u blocks (%u)\n"), r->name, r->len, r->count, len);
+}
+
 static void save_rams (struct zfile *f, int comp)
 {
+	struct saveram rams[4 + 2 * MAX_RAM_BOARDS + 3];
+	struct packblock *blocks = NULL;
 	uae_u8 *dst;
 	size_t len;
+	int cnt = 0, total = 0;
+	frame_time_t t;
 
 	dst = save_cram (&len);
-	save_chunk (f, dst, len, _T("CRAM"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("CRAM"));
 	dst = save_bram (&len);
-	save_chunk (f, dst, len, _T("BRAM"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("BRAM"));
 	dst = save_a3000lram (&len);
-	save_chunk (f, dst, len, _T("A3K1"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("A3K1"));
 	dst = save_a3000hram (&len);
-	save_chunk (f, dst, len, _T("A3K2"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("A3K2"));
 #ifdef AUTOCONFIG
 	for (int i = 0; i < MAX_RAM_BOARDS; i++) {
 		dst = save_fram(&len, i);
-		save_chunk(f, dst, len, _T("FRAM"), comp);
+		cnt = save_ram_add(rams, cnt, dst, len, _T("FRAM"));
 	}
 	for (int i = 0; i < MAX_RAM_BOARDS; i++) {
 		dst = save_zram(&len, i);
-		save_chunk(f, dst, len, _T("ZRAM"), comp);
+		cnt = save_ram_add(rams, cnt, dst, len, _T("ZRAM"));
 	}
 	dst = save_zram (&len, -1);
-	save_chunk (f, dst, len, _T("ZCRM"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("ZCRM"));
 	dst = save_bootrom (&len);
-	save_chunk (f, dst, len, _T("BORO"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("BORO"));
 #endif
 #ifdef PICASSO96
 	dst = save_pram (&len);
-	save_chunk (f, dst, len, _T("PRAM"), comp);
+	cnt = save_ram_add(rams, cnt, dst, len, _T("PRAM"));
 #endif
+
+	t = read_processor_time();
+	if (comp > 0) {
+		for (int i = 0; i < cnt; i++) {
+			if (rams[i].len >= SAVESTATE_PACK_MIN)
+				total += (int)((rams[i].len + SAVESTATE_PACK_BLOCK - 1) / SAVESTATE_PACK_BLOCK);
+		}
+		if (total)
+			blocks = xcalloc(struct packblock, total);
+	}
+	if (blocks) {
+		struct packblock *b = blocks;
+		for (int i = 0; i < cnt; i++) {
+			struct saveram *r = &rams[i];
+			if (r->len < SAVESTATE_PACK_MIN)
+				continue;
+			r->blocks = b;
+			for (size_t offset = 0; offset < r->len; offset += SAVESTATE_PACK_BLOCK) {
+				b->raw = r->mem + offset;
+				b->rawlen = (int)(r->len - offset > SAVESTATE_PACK_BLOCK ? SAVESTATE_PACK_BLOCK : r->len - offset);
+				b++;
+				r->count++;
+			}
+		}
+		savestate_pack_run(blocks, total, false);
+	}
+	for (int i = 0; i < cnt; i++) {
+		struct saveram *r = &rams[i];
+		if (r->blocks)
+			save_chunk_packed(f, r);
+		else
+			save_chunk(f, r->mem, r->len, r->name, comp);
+	}
+	if (blocks) {
+		for (int i = 0; i < total; i++) {
+			if (blocks[i].owned)
+				xfree(blocks[i].data);
+		}
+		xfree(blocks);
+		write_log(_T("RAM chunks saved in %d ms\n"), (int)((read_processor_time() - t) * 1000 / syncbase));
+	}
 }
 
 /* Save all subsystems */
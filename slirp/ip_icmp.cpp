@@ -300,7 +300,10 @@ void icmp_error(struct mbuf *msrc, u_char type, u_char code, int minsize, const
   if(!(m=m_get())) goto end_error;               /* get mbuf */
   { u_int new_m_size;
     new_m_size=(u_int)(sizeof(struct ip )+ICMP_MINLEN+msrc->m_len+ICMP_MAXDATALEN);
-    if(new_m_size>m->m_size) m_inc(m, new_m_size);
+    if(new_m_size>m->m_size && !m_inc(m, new_m_size)) {
+      m_free(m);
+      goto end_error;
+    }
   }
   memcpy(m->m_data, msrc->m_data, msrc->m_len);
   m->m_len = msrc->m_len;                        /* copy msrc to m */
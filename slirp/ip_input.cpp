@@ -351,7 +351,17 @@ insert:
 	while (q != (struct ipasfrag*)&fp->frag_link) {
 		struct mbuf *t = dtom(q);
 		q = (struct ipasfrag *) q->ipf_next;
-		m_cat(m, t);
+		if (!m_cat(m, t)) {
+			/* out of memory: drop the whole datagram */
+			while (q != (struct ipasfrag*)&fp->frag_link) {
+				t = dtom(q);
+				q = (struct ipasfrag *) q->ipf_next;
+				m_free(t);
+			}
+			remque(&fp->ip_link);
+			(void) m_free(dtom(fp));
+			goto dropfrag;
+		}
 	}
 
 	/*
@@ -52,3 +52,4 @@ extern uint8_t client_ethaddr[6];
 #endif
 
 void if_encap(const uint8_t *ip_data, int ip_data_len);
+void if_encap_mbuf(struct mbuf *m);
@@ -25,6 +25,101 @@ struct mbuf m_freelist, m_usedlist;
 int mbuf_thresh = 30;
 int mbuf_max = 0;
 size_t msize;
+struct mbstat mbstat;
+
+/*
+ * mbufs are carved out of slabs of MBUF_SLAB_COUNT entries and never
+ * returned to malloc individually, so the packet path does not hit
+ * the heap once the pool has grown to the working set.
+ */
+#define MBUF_SLAB_COUNT 32
+
+struct mbuf_slab {
+	struct mbuf_slab *next;
+	size_t pad;
+};
+static struct mbuf_slab *mbuf_slabs;
+
+/*
+ * M_EXT data buffers are kept in power of two size classes
+ * (MINCSIZE << n) with a small free list per class.
+ */
+#define MEXT_CLASSES 5
+#define MEXT_CLASS_KEEP 16
+
+struct mext_free {
+	struct mext_free *next;
+};
+static struct mext_free *mext_freelist[MEXT_CLASSES];
+static int mext_freecnt[MEXT_CLASSES];
+
+static int mext_class(size_t size)
+{
+	for (int i = 0; i < MEXT_CLASSES; i++) {
+		if (size <= ((size_t)MINCSIZE << i))
+			return i;
+	}
+	return -1;
+}
+
+static size_t mext_roundup(size_t size)
+{
+	int c = mext_class(size);
+	if (c < 0)
+		return size;
+	return (size_t)MINCSIZE << c;
+}
+
+static char *mext_alloc(size_t size)
+{
+	int c = mext_class(size);
+	if (c >= 0 && mext_freelist[c]) {
+		struct mext_free *f = mext_freelist[c];
+		mext_freelist[c] = f->next;
+		mext_freecnt[c]--;
+		mbstat.mbs_exthits++;
+		return (char*)f;
+	}
+	mbstat.mbs_extallocs++;
+	return (char*)malloc(c >= 0 ? ((size_t)MINCSIZE << c) : size);
+}
+
+static void mext_free(char *p, size_t size)
+{
+	int c = mext_class(size);
+	if (c < 0 || ((size_t)MINCSIZE << c) != size || mext_freecnt[c] >= MEXT_CLASS_KEEP) {
+		free(p);
+		return;
+	}
+	struct mext_free *f = (struct mext_free*)p;
+	f->next = mext_freelist[c];
+	mext_freelist[c] = f;
+	mext_freecnt[c]++;
+}
+
+static int m_slab_grow(void)
+{
+	struct mbuf_slab *slab;
+	char *p;
+
+	slab = (struct mbuf_slab *)malloc(sizeof(struct mbuf_slab) + MBUF_SLAB_COUNT * msize);
+	if (slab == NULL)
+		return 0;
+	slab->next = mbuf_slabs;
+	mbuf_slabs = slab;
+	p = (char*)(slab + 1);
+	for (int i = 0; i < MBUF_SLAB_COUNT; i++) {
+		struct mbuf *m = (struct mbuf *)(p + i * msize);
+		m->m_flags = M_FREELIST;
+		insque(m, &m_freelist);
+	}
+	mbuf_alloced += MBUF_SLAB_COUNT;
+	if (mbuf_alloced > mbuf_max)
+		mbuf_max = mbuf_alloced;
+	mbstat.mbs_alloced = mbuf_alloced;
+	mbstat.mbs_slabs++;
+	return 1;
+}
 
 void m_init(void)
 {
@@ -36,6 +131,7 @@ void m_init(void)
 void m_cleanup(void)
 {
     struct mbuf *m, *next;
+    struct mbuf_slab *slab;
 
     m = m_usedlist.m_next;
     while (m != &m_usedlist) {
@@ -43,15 +139,24 @@ void m_cleanup(void)
         if (m->m_flags & M_EXT) {
             free(m->m_ext);
         }
-        free(m);
         m = next;
     }
-    m = m_freelist.m_next;
-    while (m != &m_freelist) {
-        next = m->m_next;
-        free(m);
-        m = next;
+    while (mbuf_slabs) {
+        slab = mbuf_slabs->next;
+        free(mbuf_slabs);
+        mbuf_slabs = slab;
+    }
+    for (int i = 0; i < MEXT_CLASSES; i++) {
+        while (mext_freelist[i]) {
+            struct mext_free *f = mext_freelist[i]->next;
+            free(mext_freelist[i]);
+            mext_freelist[i] = f;
+        }
+        mext_freecnt[i] = 0;
     }
+    m_freelist.m_next = m_freelist.m_prev = &m_freelist;
+    m_usedlist.m_next = m_usedlist.m_prev = &m_usedlist;
+    mbuf_alloced = 0;
 }
 
 void msize_init(void)
@@ -62,39 +167,32 @@ void msize_init(void)
 	 */
 	msize = (if_mtu>if_mru?if_mtu:if_mru) + 
 			if_maxlinkhdr + sizeof(struct m_hdr ) + 6;
+	/* keep slab entries pointer aligned */
+	msize = (msize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
 }
 
 /*
  * Get an mbuf from the free list, if there are none
- * malloc one
- * 
- * Because fragmentation can occur if we alloc new mbufs and
- * free old mbufs, we mark all mbufs above mbuf_thresh as M_DOFREE,
- * which tells m_free to actually free() it
+ * grow the pool by one slab.
  */
 struct mbuf *m_get(void)
 {
 	struct mbuf *m;
-	int flags = 0;
 	
 	DEBUG_CALL("m_get");
 	
 	if (m_freelist.m_next == &m_freelist) {
-		m = (struct mbuf *)malloc(msize);
-		if (m == NULL) goto end_error;
-		mbuf_alloced++;
-		if (mbuf_alloced > mbuf_thresh)
-			flags = M_DOFREE;
-		if (mbuf_alloced > mbuf_max)
-			mbuf_max = mbuf_alloced;
-	} else {
-		m = m_freelist.m_next;
-		remque(m);
+		if (!m_slab_grow()) {
+			m = NULL;
+			goto end_error;
+		}
 	}
+	m = m_freelist.m_next;
+	remque(m);
 	
 	/* Insert it in the used list */
 	insque(m,&m_usedlist);
-	m->m_flags = (flags | M_USEDLIST);
+	m->m_flags = M_USEDLIST;
 	
 	/* Initialise it */
 	m->m_size = msize - sizeof(struct m_hdr);
@@ -118,17 +216,14 @@ void m_free(struct mbuf *m)
 	if (m->m_flags & M_USEDLIST)
 	   remque(m);
 	
-	/* If it's M_EXT, free() it */
+	/* If it's M_EXT, return it to its size class */
 	if (m->m_flags & M_EXT)
-	   free(m->m_ext);
+	   mext_free(m->m_ext, m->m_size);
 
 	/*
-	 * Either free() it or put it on the free list
+	 * Slab mbufs always go back to the free list
 	 */
-	if (m->m_flags & M_DOFREE) {
-		free(m);
-		mbuf_alloced--;
-	} else if ((m->m_flags & M_FREELIST) == 0) {
+	if ((m->m_flags & M_FREELIST) == 0) {
 		insque(m,&m_freelist);
 		m->m_flags = M_FREELIST; /* Clobber other flags */
 	}
@@ -140,52 +235,52 @@ void m_free(struct mbuf *m)
  * the other.. if result is too big for one mbuf, malloc()
  * an M_EXT data segment
  */
-void m_cat(struct mbuf *m, struct mbuf *n)
+int m_cat(struct mbuf *m, struct mbuf *n)
 {
 	/*
 	 * If there's no room, realloc
 	 */
-	if (M_FREEROOM(m) < n->m_len)
-		m_inc(m,(int)(m->m_size+MINCSIZE));
+	if (M_FREEROOM(m) < n->m_len && !m_inc(m,(int)(m->m_size+MINCSIZE))) {
+		m_free(n);
+		return 0;
+	}
 	
 	memcpy(m->m_data+m->m_len, n->m_data, n->m_len);
 	m->m_len += n->m_len;
 
 	m_free(n);
+	return 1;
 }
 
 
-/* make m size bytes large */
-void m_inc(struct mbuf *m, int size)
+/* make m size bytes large, returns 0 if out of memory */
+int m_inc(struct mbuf *m, int size)
 {
        int datasize;
+       size_t newsize;
+       char *dat;
 
 	/* some compiles throw up on gotos.  This one we can fake. */
-        if(m->m_size>size) return;
+        if(m->m_size>size) return 1;
+
+        newsize = mext_roundup(size);
+        dat = mext_alloc(newsize);
+        if (dat == NULL)
+                return 0;
 
         if (m->m_flags & M_EXT) {
-         datasize = (int)(m->m_data - m->m_ext);
-	  m->m_ext = (char *)realloc(m->m_ext,size);
-/*		if (m->m_ext == NULL)
- *			return (struct mbuf *)NULL;
- */		
-         m->m_data = m->m_ext + datasize;
+          datasize = (int)(m->m_data - m->m_ext);
+          memcpy(dat, m->m_ext, m->m_size);
+          mext_free(m->m_ext, m->m_size);
         } else {
-	  char *dat;
-	  datasize = (int)(m->m_data - m->m_dat);
-	  dat = (char *)malloc(size);
-/*		if (dat == NULL)
- *			return (struct mbuf *)NULL;
- */
-	  memcpy(dat, m->m_dat, m->m_size);
-	  
-	  m->m_ext = dat;
-	  m->m_data = m->m_ext + datasize;
-	  m->m_flags |= M_EXT;
+          datasize = (int)(m->m_data - m->m_dat);
+          memcpy(dat, m->m_dat, m->m_size);
         }
- 
-        m->m_size = size;
-
+        m->m_ext = dat;
+        m->m_data = m->m_ext + datasize;
+        m->m_flags |= M_EXT;
+        m->m_size = newsize;
+        return 1;
 }
 
 
@@ -205,6 +300,21 @@ void m_adj(struct mbuf *m, int len)
 	}
 }
 
+/*
+ * Grow m at the head by len bytes if there is enough headroom
+ * in front of m_data. Returns 0 if the caller has to copy.
+ */
+int m_prepend(struct mbuf *m, int len)
+{
+	char *start = (m->m_flags & M_EXT) ? m->m_ext : m->m_dat;
+
+	if (m->m_data - start < len)
+		return 0;
+	m->m_data -= len;
+	m->m_len += len;
+	return 1;
+}
+
 
 /*
  * Copy len bytes from m, starting off bytes into n
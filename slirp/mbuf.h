@@ -122,7 +122,11 @@ struct mbuf {
 
 struct mbstat {
 	int mbs_alloced;		/* Number of mbufs allocated */
-	
+	int mbs_slabs;			/* Number of mbuf slabs allocated */
+	int mbs_extallocs;		/* M_EXT buffers taken from malloc */
+	int mbs_exthits;		/* M_EXT buffers reused from the pool */
+	int mbs_encap_inplace;	/* Frames encapsulated without a copy */
+	int mbs_encap_copy;		/* Frames that had to be copied */
 };
 
 extern struct	mbstat mbstat;
@@ -135,9 +139,10 @@ void m_cleanup(void);
 void msize_init(void);
 struct mbuf * m_get(void);
 void m_free(struct mbuf *);
-void m_cat(struct mbuf *, struct mbuf *);
-void m_inc(struct mbuf *, int);
+int m_cat(struct mbuf *, struct mbuf *);
+int m_inc(struct mbuf *, int);
 void m_adj(struct mbuf *, int);
+int m_prepend(struct mbuf *, int);
 int m_copy(struct mbuf *, struct mbuf *, int, int);
 struct mbuf * dtom(void *);
 
@@ -675,24 +675,44 @@ void slirp_input(const uint8_t *pkt, int pkt_len)
     }
 }
 
-/* output the IP packet to the ethernet device */
-void if_encap(const uint8_t *ip_data, int ip_data_len)
+static void if_fill_ethhdr(uint8_t *buf)
 {
-    uint8_t buf[1600];
     struct ethhdr *eh = (struct ethhdr *)buf;
 
-    if (ip_data_len + ETH_HLEN > sizeof(buf))
-        return;
-
     memcpy(eh->h_dest, client_ethaddr, ETH_ALEN);
     memcpy(eh->h_source, special_ethaddr, ETH_ALEN - 1);
     /* XXX: not correct */
     eh->h_source[5] = CTL_ALIAS;
     eh->h_proto = htons(ETH_P_IP);
+}
+
+/* output the IP packet to the ethernet device */
+void if_encap(const uint8_t *ip_data, int ip_data_len)
+{
+    uint8_t buf[1600];
+
+    if (ip_data_len + ETH_HLEN > sizeof(buf))
+        return;
+
+    if_fill_ethhdr(buf);
     memcpy(buf + sizeof(struct ethhdr), ip_data, ip_data_len);
+    mbstat.mbs_encap_copy++;
     slirp_output(buf, ip_data_len + ETH_HLEN);
 }
 
+/* output the IP packet in m, building the ethernet header in the
+ * mbuf headroom so the frame is passed to the device without a copy */
+void if_encap_mbuf(struct mbuf *m)
+{
+    if (m->m_len + ETH_HLEN > 1600 || !m_prepend(m, ETH_HLEN)) {
+        if_encap((uint8_t*)m->m_data, (int)m->m_len);
+        return;
+    }
+    if_fill_ethhdr((uint8_t*)m->m_data);
+    mbstat.mbs_encap_inplace++;
+    slirp_output((uint8_t*)m->m_data, (int)m->m_len);
+}
+
 int slirp_redir(int is_udp, int host_port, 
                 struct in_addr guest_addr, int guest_port)
 {
@@ -266,6 +266,9 @@ void mbufstats(void)
 	lprint("Mbuf stats:\r\n");
 
 	lprint("  %6d mbufs allocated (%d max)\r\n", mbuf_alloced, mbuf_max);
+	lprint("  %6d mbuf slabs\r\n", mbstat.mbs_slabs);
+	lprint("  %6d ext buffers allocated, %d reused\r\n", mbstat.mbs_extallocs, mbstat.mbs_exthits);
+	lprint("  %6d frames encapsulated in place, %d copied\r\n", mbstat.mbs_encap_inplace, mbstat.mbs_encap_copy);
 	
 	i = 0;
 	for (m = m_freelist.m_next; m != &m_freelist; m = m->m_next)
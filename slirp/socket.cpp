@@ -427,7 +427,12 @@ void sorecvfrom(struct socket *so)
 	  
 	  if (n > len) {
 	    n = (int)((m->m_data - m->m_dat) + m->m_len + n + 1);
-	    m_inc(m, n);
+	    if (!m_inc(m, n)) {
+	      /* no memory for the datagram, read it to drop it */
+	      recvfrom(so->s, m->m_data, len, 0, (struct sockaddr *)&addr, &addrlen);
+	      m_free(m);
+	      return;
+	    }
 	    len = (int)M_FREEROOM(m);
 	  }
 	  /* } */
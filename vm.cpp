@@ -13,7 +13,7 @@
 #include "options.h"
 #include "memory.h"
 #ifdef _WIN32
-
+#include <io.h>
 #else
 #include <sys/mman.h>
 #endif
@@ -420,3 +420,40 @@ bool uae_vm_decommit(void *address, uae_u32 size)
     return result != MAP_FAILED;
 #endif
 }
+
+void *uae_vm_map_file(FILE *f, uae_u64 size)
+{
+	void *address;
+
+	if (!size || (size_t)size != size)
+		return NULL;
+#ifdef _WIN32
+	HANDLE h = (HANDLE)_get_osfhandle(_fileno(f));
+	if (h == INVALID_HANDLE_VALUE)
+		return NULL;
+	HANDLE m = CreateFileMapping(h, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m)
+		return NULL;
+	address = MapViewOfFile(m, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+	/* the view keeps the mapping object alive */
+	CloseHandle(m);
+#else
+	address = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+	if (address == MAP_FAILED)
+		address = NULL;
+#endif
+	uae_log("VM: Map file 0x%llx bytes at %p\n", size, address);
+	return address;
+}
+
+void uae_vm_unmap_file(void *address, uae_u64 size)
+{
+	if (!address)
+		return;
+	uae_log("VM: Unmap file 0x%llx bytes at %p\n", size, address);
+#ifdef _WIN32
+	UnmapViewOfFile(address);
+#else
+	munmap(address, (size_t)size);
+#endif
+}
@@ -0,0 +1,249 @@
+/*
+ * UAE - The Un*x Amiga Emulator
+ *
+ * RTG VRAM dirty page tracking.
+ *
+ * Host write watch (GetWriteWatch on natmem) is used when available.
+ * Otherwise VRAM pages are write protected after each scan and the
+ * fault handler marks the page dirty and reopens it, so only pages
+ * written since the previous scan are reported. Write handlers that
+ * modify VRAM without going through natmem (board blitters, handler
+ * only banks, A2410 shift register transfers) mark pages with
+ * vramwatch_mark().
+ */
+
+#include "sysconfig.h"
+#include "sysdeps.h"
+
+#include "options.h"
+#include "uae/vm.h"
+#include "vramwatch.h"
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#ifdef _WIN32
+int mman_GetWriteWatch(PVOID lpBaseAddress, SIZE_T dwRegionSize, PVOID *lpAddresses, PULONG_PTR lpdwCount, PULONG lpdwGranularity);
+void mman_ResetWatch(PVOID lpBaseAddress, SIZE_T dwRegionSize);
+#endif
+
+#define GWW_UNKNOWN 0
+#define GWW_HOST 1
+#define GWW_PROTECT 2
+#define GWW_NONE 3
+
+static uae_atomic *vram_dirty[MAX_RTG_BOARDS];
+static int vram_dirty_shift[MAX_RTG_BOARDS];
+static int vram_dirty_words[MAX_RTG_BOARDS];
+static int vram_pagesize[MAX_RTG_BOARDS];
+static volatile int gwwmode[MAX_RTG_BOARDS];
+static uae_u8 *volatile gwwbase[MAX_RTG_BOARDS];
+static uae_u32 gwwsize[MAX_RTG_BOARDS];
+
+static bool vramwatch_fault(uae_u8 *addr)
+{
+	for (int i = 0; i < MAX_RTG_BOARDS; i++) {
+		uae_u8 *base = gwwbase[i];
+		if (gwwmode[i] != GWW_PROTECT || !base || addr < base || addr >= base + gwwsize[i])
+			continue;
+		int shift = vram_dirty_shift[i];
+		uae_u32 page = (uae_u32)(addr - base) >> shift;
+		atomic_or(&vram_dirty[i][page >> 5], 1 << (page & 31));
+		uae_vm_protect(base + (page << shift), vram_pagesize[i], UAE_VM_READ_WRITE);
+		return true;
+	}
+	return false;
+}
+
+#ifdef _WIN32
+static LONG CALLBACK vramwatch_exception(PEXCEPTION_POINTERS info)
+{
+	PEXCEPTION_RECORD er = info->ExceptionRecord;
+	if (er->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && er->NumberParameters >= 2 && er->ExceptionInformation[0] == 1) {
+		if (vramwatch_fault((uae_u8*)er->ExceptionInformation[1]))
+			return EXCEPTION_CONTINUE_EXECUTION;
+	}
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+#else
+static struct sigaction gwwoldsegv;
+static void vramwatch_signal(int signum, siginfo_t *info, void *context)
+{
+	if (vramwatch_fault((uae_u8*)info->si_addr))
+		return;
+	if (gwwoldsegv.sa_flags & SA_SIGINFO)
+		gwwoldsegv.sa_sigaction(signum, info, context);
+	else if (gwwoldsegv.sa_handler != SIG_DFL && gwwoldsegv.sa_handler != SIG_IGN)
+		gwwoldsegv.sa_handler(signum);
+	else
+		abort();
+}
+#endif
+
+static bool vramwatch_install(void)
+{
+	static int installed;
+	if (installed)
+		return installed > 0;
+#ifdef _WIN32
+	installed = AddVectoredExceptionHandler(1, vramwatch_exception) ? 1 : -1;
+#else
+	struct sigaction act;
+	memset(&act, 0, sizeof act);
+	act.sa_sigaction = vramwatch_signal;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_SIGINFO;
+	installed = sigaction(SIGSEGV, &act, &gwwoldsegv) ? -1 : 1;
+#endif
+	return installed > 0;
+}
+
+static void vramwatch_release(int index)
+{
+	if (gwwmode[index] == GWW_PROTECT && gwwbase[index]) {
+		gwwmode[index] = GWW_UNKNOWN;
+		uae_vm_protect(gwwbase[index], gwwsize[index], UAE_VM_READ_WRITE);
+	}
+	gwwmode[index] = GWW_UNKNOWN;
+	gwwbase[index] = NULL;
+}
+
+static bool vramwatch_protect(int index, uae_u8 *base)
+{
+	if (!vram_dirty[index] || !vramwatch_install()) {
+		write_log(_T("RTG%d: no VRAM write watch available\n"), index);
+		gwwmode[index] = GWW_NONE;
+		return false;
+	}
+	// everything is dirty until the first scan
+	memset((void*)vram_dirty[index], 0xff, vram_dirty_words[index] * sizeof(uae_atomic));
+	gwwbase[index] = base;
+	gwwmode[index] = GWW_PROTECT;
+	if (!uae_vm_protect(base, gwwsize[index], UAE_VM_READ)) {
+		write_log(_T("RTG%d: VRAM write protection failed\n"), index);
+		gwwmode[index] = GWW_NONE;
+		gwwbase[index] = NULL;
+		return false;
+	}
+	write_log(_T("RTG%d: VRAM write watch using page protection\n"), index);
+	return true;
+}
+
+void vramwatch_mark(int index, uae_u32 offset, int size)
+{
+	uae_atomic *d = vram_dirty[index];
+	// host write watch already sees these writes
+	if (!d || size <= 0 || gwwmode[index] == GWW_HOST)
+		return;
+	int shift = vram_dirty_shift[index];
+	uae_u32 first = offset >> shift;
+	uae_u32 last = (offset + size - 1) >> shift;
+	uae_u32 maxpage = vram_dirty_words[index] * 32 - 1;
+	if (first > maxpage)
+		return;
+	if (last > maxpage)
+		last = maxpage;
+	for (uae_u32 p = first; p <= last; p++) {
+		uae_u32 mask = 1 << (p & 31);
+		// fault handler and other threads update the same words
+		if (!(d[p >> 5] & mask))
+			atomic_or(&d[p >> 5], mask);
+	}
+}
+
+int vramwatch_region(int index, uae_u8 *base, uae_u8 *start, uae_u32 size, void **buf, uae_u32 *cnt)
+{
+	uae_u32 max = *cnt;
+
+	if (gwwmode[index] == GWW_UNKNOWN || gwwmode[index] == GWW_HOST) {
+#ifdef _WIN32
+		ULONG ps;
+		ULONG_PTR hostcnt = max;
+		if (!mman_GetWriteWatch(start, size, buf, &hostcnt, &ps)) {
+			gwwmode[index] = GWW_HOST;
+			*cnt = (uae_u32)hostcnt;
+			return 0;
+		}
+#endif
+		if (gwwmode[index] == GWW_HOST)
+			return -1;
+		if (!vramwatch_protect(index, base))
+			return -1;
+	}
+	if (gwwmode[index] != GWW_PROTECT || !size)
+		return -1;
+
+	uae_atomic *dirty = vram_dirty[index];
+	int shift = vram_dirty_shift[index];
+	uae_u32 first = (uae_u32)(start - base) >> shift;
+	uae_u32 last = (uae_u32)(start + size - 1 - base) >> shift;
+	uae_u32 maxpage = (gwwsize[index] >> shift) - 1;
+	uae_u32 runstart = 0, runlen = 0;
+	uae_u32 n = 0;
+	if (last > maxpage)
+		last = maxpage;
+	for (uae_u32 p = first; p <= last; p++) {
+		uae_u32 mask = 1 << (p & 31);
+		if (!(p & 31) && !dirty[p >> 5]) {
+			p += 31;
+			continue;
+		}
+		if (!(dirty[p >> 5] & mask) || n >= max)
+			continue;
+		// the caller reads the page only after this returns, so a write
+		// between clearing and protecting is still seen by this refresh
+		atomic_and(&dirty[p >> 5], ~mask);
+		buf[n++] = base + (p << shift);
+		if (runlen && runstart + runlen == p) {
+			runlen++;
+		} else {
+			if (runlen)
+				uae_vm_protect(base + (runstart << shift), runlen << shift, UAE_VM_READ);
+			runstart = p;
+			runlen = 1;
+		}
+	}
+	if (runlen)
+		uae_vm_protect(base + (runstart << shift), runlen << shift, UAE_VM_READ);
+	*cnt = n;
+	return 0;
+}
+
+void vramwatch_reset(int index, uae_u8 *base, uae_u32 size)
+{
+	if (gwwmode[index] == GWW_PROTECT) {
+		memset((void*)vram_dirty[index], 0, vram_dirty_words[index] * sizeof(uae_atomic));
+		uae_vm_protect(base, gwwsize[index], UAE_VM_READ);
+	} else if (gwwmode[index] == GWW_HOST) {
+#ifdef _WIN32
+		mman_ResetWatch(base, size);
+#endif
+	}
+}
+
+int vramwatch_shift(int index)
+{
+	return vram_dirty_shift[index];
+}
+
+void vramwatch_free(int index)
+{
+	vramwatch_release(index);
+	xfree((void*)vram_dirty[index]);
+	vram_dirty[index] = NULL;
+	vram_dirty_words[index] = 0;
+}
+
+void vramwatch_alloc(int index, uae_u32 size)
+{
+	int shift = 0;
+
+	vramwatch_free(index);
+	vram_pagesize[index] = uae_vm_page_size();
+	while ((1 << shift) < vram_pagesize[index])
+		shift++;
+	gwwsize[index] = size & ~(vram_pagesize[index] - 1);
+	vram_dirty_shift[index] = shift;
+	vram_dirty_words[index] = (size / vram_pagesize[index] + 1 + 31) / 32 + 1;
+	vram_dirty[index] = xcalloc(uae_atomic, vram_dirty_words[index]);
+}
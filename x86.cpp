@@ -26,6 +26,11 @@
 #define DEBUG_PIT 0
 #define DEBUG_INT 0
 
+// run the x86 CPU in its own host thread
+#define X86_CPU_THREAD 1
+#define X86_THREAD_SLICE_LINES 4
+#define X86_THREAD_BACKLOG_LINES 64
+
 #include "sysconfig.h"
 #include "sysdeps.h"
 
@@ -46,6 +51,7 @@
 #include "pci_hw.h"
 #include "devices.h"
 #include "audio.h"
+#include "threaddep/thread.h"
 
 #include "pcem/ibm.h"
 #include "pcem/pic.h"
@@ -149,7 +155,7 @@ struct x86_bridge
 	bool amiga_irq;
 	bool amiga_forced_interrupts;
 	bool pc_irq3a, pc_irq3b, pc_irq7;
-	int delayed_interrupt;
+	volatile uae_atomic delayed_interrupt;
 	uae_u8 pc_jumpers;
 	int pc_maxbaseram;
 	int bios_size;
@@ -199,6 +205,23 @@ struct x86_bridge
 	bool vlsi_config;
 	int a2386flipper;
 	bool a2386_amigapcdrive;
+
+	uae_thread_id cpu_thread;
+	uae_thread_id cpu_thread_id;
+	uae_sem_t cpu_lock;
+	uae_sem_t cpu_wake;
+	volatile bool cpu_thread_running;
+	volatile bool cpu_thread_quit;
+	volatile bool cpu_thread_idle;
+	volatile bool rethink_pending;
+	volatile uae_u32 cycles_given, cycles_used;
+	int cpu_slice;
+	volatile uae_thread_id lock_owner;
+	int lock_depth;
+	volatile uae_atomic hsync_pending;
+	struct x86_disk_call *volatile disk_call;
+	uae_sem_t disk_done;
+	uae_u32 cpu_slices, cpu_lock_waits, disk_calls;
 };
 static int x86_found;
 
@@ -231,6 +254,141 @@ static struct x86_bridge *x86_bridge_alloc(void)
 	return xb;
 };
 
+/*
+ * With X86_CPU_THREAD the x86 CPU runs slices of a few scanlines worth
+ * of cycles in its own thread, holding cpu_lock while executing. Amiga
+ * side code entering PCem (bridge bank accesses, hsync/vsync work, irq
+ * lines, mouse) takes the same lock. Calls from the x86 thread into
+ * Amiga side interrupt logic are deferred to the next hsync, floppy
+ * state owned by disk.cpp is accessed through x86_disk_call().
+ */
+static bool x86_on_cpu_thread(struct x86_bridge *xb)
+{
+	return xb->cpu_thread_running && xb->cpu_thread_id == uae_thread_get_id();
+}
+
+static bool x86_lock(struct x86_bridge *xb)
+{
+	if (!xb || !xb->cpu_thread_running || x86_on_cpu_thread(xb))
+		return false;
+	// irq lines can also be changed from other threads
+	uae_thread_id self = uae_thread_get_id();
+	if (xb->lock_owner == self) {
+		xb->lock_depth++;
+		return true;
+	}
+	if (uae_sem_trywait(&xb->cpu_lock)) {
+		xb->cpu_lock_waits++;
+		uae_sem_wait(&xb->cpu_lock);
+	}
+	xb->lock_owner = self;
+	xb->lock_depth = 1;
+	return true;
+}
+
+static void x86_unlock(struct x86_bridge *xb, bool locked)
+{
+	if (locked && --xb->lock_depth == 0) {
+		xb->lock_owner = NULL;
+		uae_sem_post(&xb->cpu_lock);
+	}
+}
+
+enum { X86_DISK_GETINFO, X86_DISK_SETINFO, X86_DISK_RESET_CHANGE, X86_DISK_CLICK, X86_DISK_MOTOR };
+
+struct x86_disk_call
+{
+	int type;
+	int num, cyl, head, motor;
+	struct floppy_reserved *fr;
+	bool ret;
+};
+
+static void x86_disk_call_run(struct x86_disk_call *c)
+{
+	switch (c->type)
+	{
+	case X86_DISK_GETINFO:
+		c->ret = disk_reserved_getinfo(c->num, c->fr);
+		break;
+	case X86_DISK_SETINFO:
+		disk_reserved_setinfo(c->num, c->cyl, c->head, c->motor);
+		break;
+	case X86_DISK_RESET_CHANGE:
+		disk_reserved_reset_disk_change(c->num);
+		break;
+#ifdef DRIVESOUND
+	case X86_DISK_CLICK:
+		driveclick_click(c->num, c->cyl);
+		break;
+	case X86_DISK_MOTOR:
+		driveclick_motor(c->num, c->motor);
+		break;
+#endif
+	}
+}
+
+// emulation thread
+static void x86_disk_service(struct x86_bridge *xb)
+{
+	struct x86_disk_call *c = xb->disk_call;
+	if (!c)
+		return;
+	x86_disk_call_run(c);
+	xb->disk_calls++;
+	xb->disk_call = NULL;
+	uae_sem_post(&xb->disk_done);
+}
+
+// floppy emulation state is not thread safe, run it in the emulation thread
+static bool x86_disk_call(struct x86_disk_call *c)
+{
+	struct x86_bridge *xb = bridges[0];
+	if (!x86_on_cpu_thread(xb)) {
+		x86_disk_call_run(c);
+		return c->ret;
+	}
+	xb->disk_call = c;
+	// release the bridge lock while waiting, emulation thread may need it
+	uae_sem_post(&xb->cpu_lock);
+	uae_sem_wait(&xb->disk_done);
+	uae_sem_wait(&xb->cpu_lock);
+	return c->ret;
+}
+
+static bool x86_disk_getinfo(int num, struct floppy_reserved *fr)
+{
+	struct x86_disk_call c = { X86_DISK_GETINFO, num };
+	c.fr = fr;
+	return x86_disk_call(&c);
+}
+
+static void x86_disk_setinfo(int num, int cyl, int head, int motor)
+{
+	struct x86_disk_call c = { X86_DISK_SETINFO, num, cyl, head, motor };
+	x86_disk_call(&c);
+}
+
+static void x86_disk_reset_disk_change(int num)
+{
+	struct x86_disk_call c = { X86_DISK_RESET_CHANGE, num };
+	x86_disk_call(&c);
+}
+
+#ifdef DRIVESOUND
+static void x86_driveclick_click(int num, int cyl)
+{
+	struct x86_disk_call c = { X86_DISK_CLICK, num, cyl };
+	x86_disk_call(&c);
+}
+
+static void x86_driveclick_motor(int num, int motor)
+{
+	struct x86_disk_call c = { X86_DISK_MOTOR, num, 0, 0, motor };
+	x86_disk_call(&c);
+}
+#endif
+
 static void reset_cpu(void)
 {
 	struct x86_bridge *xb = bridges[0];
@@ -516,6 +674,11 @@ static void set_interrupt(struct x86_bridge *xb, int bit)
 #if X86_DEBUG_BRIDGE_IRQ
 	write_log(_T("IO_AMIGA_INTERRUPT_STATUS set bit %d\n"), bit);
 #endif
+	if (x86_on_cpu_thread(xb)) {
+		atomic_or(&xb->delayed_interrupt, 1 << bit);
+		xb->rethink_pending = true;
+		return;
+	}
 	xb->amiga_io[IO_AMIGA_INTERRUPT_STATUS] |= 1 << bit;
 	devices_rethink_all(x86_bridge_rethink);
 }
@@ -528,15 +691,19 @@ void x86_ack_keyboard(void)
 void x86_clearirq(uint8_t irqnum)
 {
 	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
 
 	picintc(1 << irqnum);
+	x86_unlock(xb, locked);
 }
 
 void x86_doirq(uint8_t irqnum)
 {
 	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
 
 	picint(1 << irqnum);
+	x86_unlock(xb, locked);
 }
 
 struct pc_floppy
@@ -615,10 +782,10 @@ static void do_floppy_seek(int num, int error)
 {
 	struct pc_floppy *pcf = &floppy_pc[floppy_num];
 
-	disk_reserved_reset_disk_change(num);
+	x86_disk_reset_disk_change(num);
 	if (!error) {
 		struct floppy_reserved fr = { 0 };
-		bool valid_floppy = disk_reserved_getinfo(floppy_num, &fr);
+		bool valid_floppy = x86_disk_getinfo(floppy_num, &fr);
 		if (floppy_seekcyl[num] != pcf->phys_cyl) {
 			if (floppy_seekcyl[num] > pcf->phys_cyl)
 				pcf->phys_cyl++;
@@ -627,7 +794,7 @@ static void do_floppy_seek(int num, int error)
 
 #ifdef DRIVESOUND
 			if (valid_floppy)
-				driveclick_click(fr.num, pcf->phys_cyl);
+				x86_driveclick_click(fr.num, pcf->phys_cyl);
 #endif
 #if FLOPPY_DEBUG
 			write_log(_T("Floppy%d seeking.. %d\n"), floppy_num, pcf->phys_cyl);
@@ -649,7 +816,7 @@ static void do_floppy_seek(int num, int error)
 				pcf->cyl = pcf->phys_cyl;
 
 			floppy_seeking[num] = PC_SEEK_DELAY;
-			disk_reserved_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
+			x86_disk_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
 			return;
 		}
 
@@ -721,7 +888,7 @@ static void floppy_do_cmd(struct x86_bridge *xb)
 	struct floppy_reserved fr = { 0 };
 	bool valid_floppy;
 
-	valid_floppy = disk_reserved_getinfo(floppy_num, &fr);
+	valid_floppy = x86_disk_getinfo(floppy_num, &fr);
 
 #if FLOPPY_DEBUG
 	if (floppy_cmd_len) {
@@ -871,7 +1038,7 @@ static void floppy_do_cmd(struct x86_bridge *xb)
 			floppy_result[1] = floppy_status[1];
 			floppy_result[2] = floppy_status[2];
 			floppy_delay_hsync = 10;
-			disk_reserved_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
+			x86_disk_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
 		}
 		break;
 
@@ -946,7 +1113,7 @@ static void floppy_do_cmd(struct x86_bridge *xb)
 			floppy_result[1] = floppy_status[1];
 			floppy_result[2] = floppy_status[2];
 			floppy_delay_hsync = 10;
-			disk_reserved_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
+			x86_disk_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
 		}
 		break;
 
@@ -985,7 +1152,7 @@ static void floppy_do_cmd(struct x86_bridge *xb)
 		}
 
 		floppy_delay_hsync = 10;
-		disk_reserved_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
+		x86_disk_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
 		break;
 
 		case 13:
@@ -1033,7 +1200,7 @@ static void floppy_do_cmd(struct x86_bridge *xb)
 			floppy_result[5] = pcf->sector + 1;
 			floppy_result[6] = floppy_cmd[2];
 			floppy_delay_hsync = 10;
-			disk_reserved_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
+			x86_disk_setinfo(floppy_num, pcf->cyl, pcf->head, 1);
 		}
 		break;
 
@@ -1089,16 +1256,16 @@ static void outfloppy(struct x86_bridge *xb, int portnum, uae_u8 v)
 			int mask = 0x10 << i;
 			if ((floppy_dpc & mask) != (v & mask)) {
 				struct floppy_reserved fr = { 0 };
-				bool valid_floppy = disk_reserved_getinfo(i, &fr);
+				bool valid_floppy = x86_disk_getinfo(i, &fr);
 				if (valid_floppy)
-					driveclick_motor(fr.num, (v & mask) ? 1 : 0);
+					x86_driveclick_motor(fr.num, (v & mask) ? 1 : 0);
 			}
 		}
 #endif
 		floppy_dpc = v;
 		floppy_num = v & 3;
 		for (int i = 0; i < 2; i++) {
-			disk_reserved_setinfo(0, floppy_pc[i].cyl, floppy_pc[i].head, floppy_selected() == i);
+			x86_disk_setinfo(0, floppy_pc[i].cyl, floppy_pc[i].head, floppy_selected() == i);
 		}
 		break;
 		case 0x3f5: // data reg
@@ -1199,7 +1366,7 @@ static uae_u8 infloppy(struct x86_bridge *xb, int portnum)
 		case 0x3f7: // digital input register
 		if (xb->type >= TYPE_2286) {
 			struct floppy_reserved fr = { 0 };
-			bool valid_floppy = disk_reserved_getinfo(floppy_num, &fr);
+			bool valid_floppy = x86_disk_getinfo(floppy_num, &fr);
 			v = 0x00;
 			if (valid_floppy && fr.disk_changed)
 				v = 0x80;
@@ -1238,13 +1405,13 @@ static void set_pc_address_access(struct x86_bridge *xb, uaecptr addr)
 	if (addr >= 0xb0000 && addr < 0xb2000) {
 		// mono
 		if (xb->amiga_io[IO_MODE_REGISTER] & 8) {
-			xb->delayed_interrupt |= 1 << 0;
+			atomic_or(&xb->delayed_interrupt, 1 << 0);
 		}
 	}
 	if (addr >= 0xb8000 && addr < 0xc0000) {
 		// color
 		if (xb->amiga_io[IO_MODE_REGISTER] & 16) {
-			xb->delayed_interrupt |= 1 << 1;
+			atomic_or(&xb->delayed_interrupt, 1 << 1);
 		}
 	}
 }
@@ -1273,7 +1440,7 @@ static void set_pc_io_access(struct x86_bridge *xb, uaecptr portnum, bool write)
 		}
 		// mono crt data register
 		if (mode_register & 8) {
-			xb->delayed_interrupt |= 1 << 2;
+			atomic_or(&xb->delayed_interrupt, 1 << 2);
 		}
 	} else if (write && (portnum == 0x3d1 || portnum == 0x3d3 || portnum == 0x3d5 || portnum == 0x3d7 || portnum == 0x3d8 || portnum == 0x3d9 || portnum == 0x3dd)) {
 		// color crt data register
@@ -1281,7 +1448,7 @@ static void set_pc_io_access(struct x86_bridge *xb, uaecptr portnum, bool write)
 			set_initial_cpu_turbo(xb);
 		}
 		if (mode_register & 16) {
-			xb->delayed_interrupt |= 1 << 3;
+			atomic_or(&xb->delayed_interrupt, 1 << 3);
 		}
 	} else if (portnum >= 0x37a && portnum < 0x37b) {
 		// LPT1
@@ -2579,7 +2746,7 @@ static void cga_gfx_read(struct x86_bridge *xb, uaecptr a_addr, uae_u8 *addr, ua
 	*plane1p = plane1;
 }
 
-static uae_u32 REGPARAM2 x86_bridge_wget(uaecptr addr)
+static uae_u32 x86_bridge_wget2(uaecptr addr)
 {
 	uae_u16 v = 0;
 	uae_u8 *base;
@@ -2619,6 +2786,14 @@ static uae_u32 REGPARAM2 x86_bridge_wget(uaecptr addr)
 #endif
 	return v;
 }
+static uae_u32 REGPARAM2 x86_bridge_wget(uaecptr addr)
+{
+	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
+	uae_u32 v = x86_bridge_wget2(addr);
+	x86_unlock(xb, locked);
+	return v;
+}
 static uae_u32 REGPARAM2 x86_bridge_lget(uaecptr addr)
 {
 	uae_u32 v;
@@ -2627,7 +2802,7 @@ static uae_u32 REGPARAM2 x86_bridge_lget(uaecptr addr)
 	return v;
 }
 
-static uae_u32 REGPARAM2 x86_bridge_bget(uaecptr addr)
+static uae_u32 x86_bridge_bget2(uaecptr addr)
 {
 	uae_u8 v = 0;
 	uae_u8 *base;
@@ -2671,8 +2846,16 @@ static uae_u32 REGPARAM2 x86_bridge_bget(uaecptr addr)
 #endif
 	return v;
 }
+static uae_u32 REGPARAM2 x86_bridge_bget(uaecptr addr)
+{
+	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
+	uae_u32 v = x86_bridge_bget2(addr);
+	x86_unlock(xb, locked);
+	return v;
+}
 
-static void REGPARAM2 x86_bridge_wput(uaecptr addr, uae_u32 b)
+static void x86_bridge_wput2(uaecptr addr, uae_u32 b)
 {
 	struct x86_bridge *xb = get_x86_bridge(addr);
 	if (!xb)
@@ -2710,12 +2893,19 @@ static void REGPARAM2 x86_bridge_wput(uaecptr addr, uae_u32 b)
 		break;
 	}
 }
+static void REGPARAM2 x86_bridge_wput(uaecptr addr, uae_u32 b)
+{
+	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
+	x86_bridge_wput2(addr, b);
+	x86_unlock(xb, locked);
+}
 static void REGPARAM2 x86_bridge_lput(uaecptr addr, uae_u32 b)
 {
 	x86_bridge_wput(addr, b >> 16);
 	x86_bridge_wput(addr + 2, b);
 }
-static void REGPARAM2 x86_bridge_bput(uaecptr addr, uae_u32 b)
+static void x86_bridge_bput2(uaecptr addr, uae_u32 b)
 {
 	struct x86_bridge *xb = get_x86_bridge(addr);
 	if (!xb)
@@ -2767,6 +2957,13 @@ static void REGPARAM2 x86_bridge_bput(uaecptr addr, uae_u32 b)
 		break;
 	}
 }
+static void REGPARAM2 x86_bridge_bput(uaecptr addr, uae_u32 b)
+{
+	struct x86_bridge *xb = bridges[0];
+	bool locked = x86_lock(xb);
+	x86_bridge_bput2(addr, b);
+	x86_unlock(xb, locked);
+}
 
 addrbank x86_bridge_bank = {
 	x86_bridge_lget, x86_bridge_wget, x86_bridge_bget,
@@ -2980,8 +3177,7 @@ static void x86_bridge_rethink(void)
 	if (!xb)
 		return;
 	if (!(xb->amiga_io[IO_CONTROL_REGISTER] & 1)) {
-		xb->amiga_io[IO_AMIGA_INTERRUPT_STATUS] |= xb->delayed_interrupt;
-		xb->delayed_interrupt = 0;
+		xb->amiga_io[IO_AMIGA_INTERRUPT_STATUS] |= (uae_u8)atomic_and(&xb->delayed_interrupt, 0);
 		uae_u8 intreq = xb->amiga_io[IO_AMIGA_INTERRUPT_STATUS];
 		uae_u8 intena = xb->amiga_io[IO_INTERRUPT_MASK];
 		uae_u8 status = intreq & ~intena;
@@ -2990,12 +3186,15 @@ static void x86_bridge_rethink(void)
 	}
 }
 
+static void x86_cpu_thread_stop(struct x86_bridge *xb);
+
 static void x86_bridge_reset(int hardreset)
 {
 	for (int i = 0; i < X86_BRIDGE_MAX; i++) {
 		struct x86_bridge *xb = bridges[i];
 		if (!xb)
 			continue;
+		x86_cpu_thread_stop(xb);
 		if (xb->ne2000_isa) {
 			xb->ne2000_isa->free(xb->ne2000_isa_board_state);
 			xb->ne2000_isa = NULL;
@@ -3080,6 +3279,84 @@ static void x86_cpu_execute(int cycs)
 	check_floppy_delay();
 }
 
+static void x86_cpu_thread(void *v)
+{
+	struct x86_bridge *xb = (struct x86_bridge*)v;
+
+	xb->cpu_thread_id = uae_thread_get_id();
+	xb->cpu_thread_running = true;
+	while (!xb->cpu_thread_quit) {
+		int budget = (int)(xb->cycles_given - xb->cycles_used);
+		if (budget <= 0) {
+			xb->cpu_thread_idle = true;
+			uae_sem_trywait_delay(&xb->cpu_wake, 10);
+			xb->cpu_thread_idle = false;
+			continue;
+		}
+		if (budget > xb->cpu_slice)
+			budget = xb->cpu_slice;
+		uae_sem_wait(&xb->cpu_lock);
+		// per-line device work of the hsyncs since the previous slice
+		int lines = atomic_and(&xb->hsync_pending, 0);
+		while (lines-- > 0 && !xb->cpu_thread_quit) {
+			check_floppy_delay();
+			if (xb->ne2000_isa)
+				xb->ne2000_isa->hsync(xb->ne2000_isa_board_state);
+		}
+		if (!xb->cpu_thread_quit)
+			x86_cpu_execute(budget);
+		uae_sem_post(&xb->cpu_lock);
+		xb->cycles_used += budget;
+		xb->cpu_slices++;
+	}
+	xb->cpu_thread_running = false;
+}
+
+static void x86_cpu_thread_start(struct x86_bridge *xb)
+{
+	if (!X86_CPU_THREAD || xb->cpu_thread)
+		return;
+	uae_sem_init(&xb->cpu_lock, 0, 1);
+	uae_sem_init(&xb->cpu_wake, 0, 0);
+	uae_sem_init(&xb->disk_done, 0, 0);
+	xb->cpu_thread_quit = false;
+	xb->cycles_given = xb->cycles_used = 0;
+	xb->hsync_pending = 0;
+	xb->disk_call = NULL;
+	xb->lock_owner = NULL;
+	xb->lock_depth = 0;
+	xb->cpu_slices = xb->cpu_lock_waits = xb->disk_calls = 0;
+	if (!uae_start_thread(_T("x86"), x86_cpu_thread, xb, &xb->cpu_thread)) {
+		write_log(_T("x86 CPU thread failed to start\n"));
+		xb->cpu_thread = 0;
+		uae_sem_destroy(&xb->cpu_lock);
+		uae_sem_destroy(&xb->cpu_wake);
+		uae_sem_destroy(&xb->disk_done);
+		return;
+	}
+	while (!xb->cpu_thread_running)
+		sleep_millis(1);
+}
+
+static void x86_cpu_thread_stop(struct x86_bridge *xb)
+{
+	if (!xb->cpu_thread)
+		return;
+	xb->cpu_thread_quit = true;
+	uae_sem_post(&xb->cpu_wake);
+	// thread may be waiting for a floppy call
+	while (xb->cpu_thread_running) {
+		x86_disk_service(xb);
+		sleep_millis(1);
+	}
+	uae_wait_thread(xb->cpu_thread);
+	xb->cpu_thread = 0;
+	uae_sem_destroy(&xb->cpu_lock);
+	uae_sem_destroy(&xb->cpu_wake);
+	uae_sem_destroy(&xb->disk_done);
+	write_log(_T("x86 CPU thread: %u slices, %u lock waits, %u floppy calls\n"), xb->cpu_slices, xb->cpu_lock_waits, xb->disk_calls);
+}
+
 static bool audio_state_sndboard_x86(int streamid, void *param)
 {
 	static int smp[2] = { 0, 0 };
@@ -3126,6 +3403,7 @@ static void x86_bridge_vsync(void)
 	if (!xb)
 		return;
 
+	bool locked = x86_lock(xb);
 	if (xb->delayed_interrupt) {
 		devices_rethink_all(x86_bridge_rethink);
 	}
@@ -3134,6 +3412,7 @@ static void x86_bridge_vsync(void)
 		xb->mouse_port = (rc->device_settings & 3) + 1;
 	}
 	xb->audeventtime = (int)(x86_base_event_clock * CYCLE_UNIT / currprefs.sound_freq + 1);
+	x86_unlock(xb, locked);
 }
 
 static void x86_bridge_hsync(void)
@@ -3155,22 +3434,45 @@ static void x86_bridge_hsync(void)
 		}
 	}
 
-	check_floppy_delay();
-
-	if (xb->ne2000_isa)
-		xb->ne2000_isa->hsync(xb->ne2000_isa_board_state);
+	if (xb->cpu_thread_running) {
+		// CPU thread runs the per-line work with its next slice,
+		// only floppy calls from it need this thread
+		x86_disk_service(xb);
+		atomic_inc(&xb->hsync_pending);
+	} else {
+		check_floppy_delay();
+		if (xb->ne2000_isa)
+			xb->ne2000_isa->hsync(xb->ne2000_isa_board_state);
+	}
 
 	if (!xb->x86_reset) {
 		float cycles_to_run = (float)cpu_get_speed() / (vblank_hz * maxvpos);
 		totalcycles += cycles_to_run;
 		int cycs = (int)totalcycles;
-		x86_cpu_execute(cycs);
+		if (xb->cpu_thread_running) {
+			// hand cycles to the CPU thread, it runs them in larger slices
+			int backlog = (int)(xb->cycles_given - xb->cycles_used);
+			xb->cpu_slice = cycs * X86_THREAD_SLICE_LINES;
+			if (backlog < cycs * X86_THREAD_BACKLOG_LINES)
+				xb->cycles_given += cycs;
+			if (xb->cpu_thread_idle)
+				uae_sem_post(&xb->cpu_wake);
+		} else {
+			x86_cpu_execute(cycs);
+		}
 		totalcycles -= (int)totalcycles;
 	}
 
 	if (currprefs.x86_speed_throttle != changed_prefs.x86_speed_throttle) {
+		bool locked = x86_lock(xb);
 		currprefs.x86_speed_throttle = changed_prefs.x86_speed_throttle;
 		set_cpu_turbo(xb);
+		x86_unlock(xb, locked);
+	}
+
+	if (xb->rethink_pending) {
+		xb->rethink_pending = false;
+		devices_rethink_all(x86_bridge_rethink);
 	}
 }
 
@@ -3521,6 +3823,7 @@ void x86_mouse(int port, int x, int y, int z, int b)
 	struct x86_bridge *xb = bridges[0];
 	if (!xb || !xb->mouse_port || !xb->mouse_base || xb->mouse_port != port + 1)
 		return;
+	bool locked = x86_lock(xb);
 	switch (xb->mouse_type)
 	{
 		case 0:
@@ -3532,6 +3835,7 @@ void x86_mouse(int port, int x, int y, int z, int b)
 		mouse_ps2_poll(x, y, z, b, xb->mouse_base);
 		break;
 	}
+	x86_unlock(xb, locked);
 }
 
 void *mouse_serial_init();
@@ -3857,6 +4161,8 @@ bool x86_bridge_init(struct autoconfig_info *aci, uae_u32 romtype, int type)
 	device_add_exit(x86_bridge_free);
 	device_add_rethink(x86_bridge_rethink);
 
+	x86_cpu_thread_start(xb);
+
 	return true;
 }
 
@@ -4004,8 +4310,10 @@ void x86_update_sound(float clk)
 	struct x86_bridge *xb = bridges[0];
 	x86_base_event_clock = clk;
 	if (xb) {
+		bool locked = x86_lock(xb);
 		xb->audeventtime = (int)(x86_base_event_clock * CYCLE_UNIT / currprefs.sound_freq + 1);
 		sound_speed_changed(false);
+		x86_unlock(xb, locked);
 	}
 }
 
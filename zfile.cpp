@@ -24,6 +24,7 @@
 #include "diskutil.h"
 #include "fdi2raw.h"
 #include "uae/io.h"
+#include "uae/vm.h"
 
 #include "archivers/zip/unzip.h"
 #include "archivers/dms/pfile.h"
@@ -34,6 +35,12 @@ static struct zfile *zlist = 0;
 const TCHAR *uae_archive_extensions[] = { _T("zip"), _T("rar"), _T("7z"), _T("lha"), _T("lzh"), _T("lzx"), _T("tar"), NULL };
 
 #define MAX_CACHE_ENTRIES 10
+// total unpacked bytes kept in zcache across all disk images
+#define MAX_CACHE_SIZE (64 * 1024 * 1024)
+// plain read-only files at least this large are memory mapped
+#define ZFILE_MAP_MIN (256 * 1024)
+// gzip images at least this large are unpacked on demand
+#define ZFILE_LAZY_MIN (8 * 1024 * 1024)
 
 struct zdisktrack
 {
@@ -54,16 +61,24 @@ struct zcache
 	struct zcache *next;
 	time_t tm;
 };
+// most recently used first
 static struct zcache *zcachedata;
+static int zcachesize;
 
 static struct zcache *cache_get (const TCHAR *name)
 {
-	struct zcache *zc = zcachedata;
+	struct zcache *zc = zcachedata, *prev = NULL;
 	while (zc) {
 		if (!_tcscmp (name, zc->name)) {
 			zc->tm = time (NULL);
+			if (prev) {
+				prev->next = zc->next;
+				zc->next = zcachedata;
+				zcachedata = zc;
+			}
 			return zc;
 		}
+		prev = zc;
 		zc = zc->next;
 	}
 	return NULL;
@@ -84,13 +99,13 @@ static void zcache_free_data (struct zcache *zc)
 	}
 	xfree (zc->data);
 	xfree (zc->name);
+	zcachesize -= zc->size;
 }
 
 static void zcache_free (struct zcache *zc)
 {
 	struct zcache *pl = NULL;
 	struct zcache *l  = zcachedata;
-	struct zcache *nxt;
 
 	while (l != zc) {
 		if (l == 0)
@@ -98,15 +113,12 @@ static void zcache_free (struct zcache *zc)
 		pl = l;
 		l = l->next;
 	}
-	if (l)
-		nxt = l->next;
-	zcache_free_data (zc);
-	if (l == 0)
-		return;
 	if(!pl)
-		zcachedata = nxt;
+		zcachedata = zc->next;
 	else
-		pl->next = nxt;
+		pl->next = zc->next;
+	zcache_free_data (zc);
+	xfree (zc);
 }
 
 static void zcache_close (void)
@@ -115,34 +127,45 @@ static void zcache_close (void)
 	while (zc) {
 		struct zcache *n = zc->next;
 		zcache_free_data (zc);
-		xfree (n);
+		xfree (zc);
 		zc = n;
 	}
+	zcachedata = NULL;
+	zcachesize = 0;
 }
 
-static void zcache_check (void)
+// drop least recently used entries until size more bytes fit
+static void zcache_check (int size)
 {
-	int cnt = 0;
-	struct zcache *zc = zcachedata, *last = NULL;
-	while (zc) {
-		last = zc;
-		zc = zc->next;
-		cnt++;
-	}
-	write_log (_T("CACHE: %d\n"), cnt);
-	if (cnt >= MAX_CACHE_ENTRIES && last)
+	for (;;) {
+		int cnt = 0;
+		struct zcache *zc = zcachedata, *last = NULL;
+		while (zc) {
+			last = zc;
+			zc = zc->next;
+			cnt++;
+		}
+		if (!last || (cnt < MAX_CACHE_ENTRIES && zcachesize + size <= MAX_CACHE_SIZE))
+			break;
+		write_log (_T("CACHE: %d entries, %d bytes, dropping '%s'\n"), cnt, zcachesize, last->name);
 		zcache_free (last);
+	}
 }
 
 static struct zcache *zcache_put (const TCHAR *name, struct zdiskimage *data)
 {
 	struct zcache *zc;
-	
-	zcache_check ();
+	int size = sizeof (struct zdiskimage);
+
+	for (int i = 0; i < data->tracks; i++)
+		size += data->zdisktracks[i].len;
+	zcache_check (size);
 	zc = xcalloc (struct zcache, 1);
 	zc->next = zcachedata;
 	zcachedata = zc;
 	zc->zd = data;
+	zc->size = size;
+	zcachesize += size;
 	zc->name = my_strdup (name);
 	zc->tm = time (NULL);
 	return zc;
@@ -178,6 +201,10 @@ static struct zfile *zfile_create (struct zfile *prev, const TCHAR *originalname
 
 static void zfile_free (struct zfile *f)
 {
+	if (f->zfileclose)
+		f->zfileclose (f);
+	if (f->mapped)
+		uae_vm_unmap_file (f->mapped, f->size);
 	if (f->f)
 		fclose (f->f);
 	if (f->deleteafterclose) {
@@ -192,13 +219,19 @@ static void zfile_free (struct zfile *f)
 	xfree (f);
 }
 
+static bool zfile_exiting;
+
 void zfile_exit (void)
 {
 	struct zfile *l;
+	// everything is freed here, close hooks must not touch zlist
+	zfile_exiting = true;
 	while ((l = zlist)) {
 		zlist = l->next;
 		zfile_free (l);
 	}
+	zfile_exiting = false;
+	zcache_close ();
 }
 
 void zfile_fclose (struct zfile *f)
@@ -541,6 +574,233 @@ end:
 	return z;
 }
 
+// seekable on-demand gzip reader, keeps a copy of the inflate state
+// every ZGZ_SPAN bytes so seeking backwards does not restart from 0.
+#define ZGZ_SPAN (1024 * 1024)
+#define ZGZ_MAXPOINTS 256
+
+struct zfile_gzpoint
+{
+	uae_s64 out;
+	uae_s64 in;
+	z_stream zs;
+};
+struct zfile_gz
+{
+	struct zfile *src;
+	z_stream zs;
+	uae_s64 out;
+	uae_s64 in;
+	uae_s64 size;
+	// CRC of the output decoded so far in order, checked against the trailer
+	uae_s64 crcout;
+	uae_u32 crc, crcwant;
+	bool eof, error;
+	int points;
+	struct zfile_gzpoint point[ZGZ_MAXPOINTS];
+	uae_u8 inbuf[16384];
+	uae_u8 skipbuf[32768];
+};
+
+// inflate until the output buffer is full, the stream ended or it is broken
+static void zfile_gz_run (struct zfile_gz *gz)
+{
+	int ret;
+
+	while (gz->zs.avail_out > 0) {
+		if (gz->zs.avail_in == 0) {
+			size_t got;
+			zfile_fseek (gz->src, gz->in, SEEK_SET);
+			got = zfile_fread (gz->inbuf, 1, sizeof gz->inbuf, gz->src);
+			if (got == 0) {
+				// compressed data is truncated
+				gz->error = true;
+				break;
+			}
+			gz->in += got;
+			gz->zs.next_in = gz->inbuf;
+			gz->zs.avail_in = (uInt)got;
+		}
+		ret = inflate (&gz->zs, Z_NO_FLUSH);
+		if (ret == Z_STREAM_END) {
+			gz->eof = true;
+			break;
+		}
+		if (ret != Z_OK) {
+			gz->error = true;
+			break;
+		}
+	}
+}
+
+// end of stream must match ISIZE and, if everything was decoded in order, the CRC
+static void zfile_gz_check_end (struct zfile_gz *gz)
+{
+	if (!gz->eof && !gz->error && gz->out == gz->size) {
+		uae_u8 extra;
+		gz->zs.next_out = &extra;
+		gz->zs.avail_out = 1;
+		zfile_gz_run (gz);
+		if (gz->zs.avail_out == 0)
+			gz->error = true;
+	}
+	if (gz->eof && (gz->out != gz->size || (gz->crcout == gz->out && gz->crc != gz->crcwant)))
+		gz->error = true;
+}
+
+static int zfile_gz_inflate (struct zfile_gz *gz, uae_u8 *buf, uae_u64 len)
+{
+	uae_s64 next = (uae_s64)gz->points * ZGZ_SPAN;
+	uInt want;
+
+	if (gz->error)
+		return -1;
+	if (gz->eof)
+		return 0;
+
+	if (gz->points < ZGZ_MAXPOINTS && gz->out == next) {
+		struct zfile_gzpoint *p = &gz->point[gz->points];
+		if (inflateCopy (&p->zs, &gz->zs) == Z_OK) {
+			p->out = gz->out;
+			p->in = gz->in - gz->zs.avail_in;
+			gz->points++;
+			next += ZGZ_SPAN;
+		}
+	}
+	if (gz->points < ZGZ_MAXPOINTS && gz->out + (uae_s64)len > next)
+		len = next - gz->out;
+	if (len > 0x40000000)
+		len = 0x40000000;
+	want = (uInt)len;
+	gz->zs.next_out = buf;
+	gz->zs.avail_out = want;
+	zfile_gz_run (gz);
+	want -= gz->zs.avail_out;
+	if (gz->out <= gz->crcout && gz->crcout < gz->out + want) {
+		uInt skip = (uInt)(gz->crcout - gz->out);
+		gz->crc = crc32 (gz->crc, buf + skip, want - skip);
+		gz->crcout = gz->out + want;
+	}
+	gz->out += want;
+	zfile_gz_check_end (gz);
+	if (gz->error)
+		return -1;
+	return want;
+}
+
+static bool zfile_gz_restore (struct zfile_gz *gz, int idx)
+{
+	struct zfile_gzpoint *p = &gz->point[idx];
+	inflateEnd (&gz->zs);
+	if (inflateCopy (&gz->zs, &p->zs) != Z_OK)
+		return false;
+	gz->out = p->out;
+	gz->in = p->in;
+	gz->zs.avail_in = 0;
+	gz->eof = false;
+	return true;
+}
+
+static bool zfile_gz_seek (struct zfile_gz *gz, uae_s64 pos)
+{
+	int idx = (int)(pos / ZGZ_SPAN);
+	if (idx >= gz->points)
+		idx = gz->points - 1;
+	if (pos < gz->out || gz->point[idx].out > gz->out) {
+		if (!zfile_gz_restore (gz, idx))
+			return false;
+	}
+	while (gz->out < pos) {
+		uae_u64 skip = pos - gz->out;
+		if (skip > sizeof gz->skipbuf)
+			skip = sizeof gz->skipbuf;
+		if (zfile_gz_inflate (gz, gz->skipbuf, skip) <= 0)
+			return false;
+	}
+	return true;
+}
+
+static uae_s64 zfile_gz_fread (void *data, uae_u64 l1, uae_u64 l2, struct zfile *zf)
+{
+	struct zfile_gz *gz = (struct zfile_gz*)zf->userdata;
+	uae_u64 size = l1 * l2;
+	uae_u64 done = 0;
+
+	if (!l1 || !l2 || zf->seek >= zf->size)
+		return 0;
+	if (zf->seek + size > zf->size)
+		size = zf->size - zf->seek;
+	if (!zfile_gz_seek (gz, zf->seek))
+		return 0;
+	while (done < size) {
+		int got = zfile_gz_inflate (gz, (uae_u8*)data + done, size - done);
+		if (got <= 0)
+			break;
+		done += got;
+	}
+	if (gz->error) {
+		write_log (_T("%s: corrupt or truncated gzip data at %lld\n"), zf->name, gz->out);
+		return 0;
+	}
+	zf->seek += done;
+	return done / l1;
+}
+
+static uae_s64 zfile_gz_fwrite (const void *data, uae_u64 l1, uae_u64 l2, struct zfile *zf)
+{
+	return 0;
+}
+
+static void zfile_gz_close (struct zfile *zf)
+{
+	struct zfile_gz *gz = (struct zfile_gz*)zf->userdata;
+	if (!gz)
+		return;
+	inflateEnd (&gz->zs);
+	for (int i = 0; i < gz->points; i++)
+		inflateEnd (&gz->point[i].zs);
+	if (!zfile_exiting)
+		zfile_fclose (gz->src);
+}
+
+static struct zfile *zfile_gunzip_lazy (struct zfile *z, const TCHAR *name, uae_s64 offset, int size, uae_u32 crc)
+{
+	struct zfile_gz *gz;
+	struct zfile *z2;
+
+	gz = xcalloc (struct zfile_gz, 1);
+	if (!gz)
+		return NULL;
+	if (inflateInit2_ (&gz->zs, -MAX_WBITS, ZLIB_VERSION, sizeof (z_stream)) != Z_OK) {
+		xfree (gz);
+		return NULL;
+	}
+	if (inflateCopy (&gz->point[0].zs, &gz->zs) != Z_OK) {
+		inflateEnd (&gz->zs);
+		xfree (gz);
+		return NULL;
+	}
+	gz->point[0].out = 0;
+	gz->point[0].in = offset;
+	gz->points = 1;
+	gz->in = offset;
+	gz->size = size;
+	gz->crc = crc32 (0, Z_NULL, 0);
+	gz->crcwant = crc;
+	gz->src = z;
+	z2 = zfile_create (z, NULL);
+	z2->name = my_strdup (name);
+	z2->size = size;
+	z2->datasize = size;
+	z2->dataseek = 1;
+	z2->userdata = gz;
+	z2->zfileread = zfile_gz_fread;
+	z2->zfilewrite = zfile_gz_fwrite;
+	z2->zfileclose = zfile_gz_close;
+	write_log (_T("%s: %d bytes, unpacking on demand\n"), name, size);
+	return z2;
+}
+
 static struct zfile *zfile_gunzip (struct zfile *z, int *retcode)
 {
 	uae_u8 header[2 + 1 + 1 + 4 + 1 + 1];
@@ -548,6 +808,7 @@ static struct zfile *zfile_gunzip (struct zfile *z, int *retcode)
 	int i, size, ret, first;
 	uae_u8 flags;
 	uae_s64 offset;
+	uae_u32 crc;
 	TCHAR name[MAX_DPATH];
 	uae_u8 buffer[8192];
 	struct zfile *z2;
@@ -591,7 +852,15 @@ static struct zfile *zfile_gunzip (struct zfile *z, int *retcode)
 	}
 	removeext (name, _T(".gz"));
 	offset = zfile_ftell (z);
-	zfile_fseek (z, -4, SEEK_END);
+	zfile_fseek (z, -8, SEEK_END);
+	zfile_fread (&b, 1, 1, z);
+	crc = b;
+	zfile_fread (&b, 1, 1, z);
+	crc |= b << 8;
+	zfile_fread (&b, 1, 1, z);
+	crc |= b << 16;
+	zfile_fread (&b, 1, 1, z);
+	crc |= (uae_u32)b << 24;
 	zfile_fread (&b, 1, 1, z);
 	size = b;
 	zfile_fread (&b, 1, 1, z);
@@ -602,6 +871,12 @@ static struct zfile *zfile_gunzip (struct zfile *z, int *retcode)
 	size |= b << 24;
 	if (size < 8 || size > 256 * 1024 * 1024) /* safety check */
 		return NULL;
+	if (size >= ZFILE_LAZY_MIN) {
+		/* z is owned by the returned file */
+		z2 = zfile_gunzip_lazy (z, name, offset, size, crc);
+		if (z2)
+			return z2;
+	}
 	zfile_fseek (z, offset, SEEK_SET);
 	z2 = zfile_fopen_empty (z, name, size);
 	if (!z2)
@@ -1618,6 +1893,22 @@ static struct zfile *zfile_opensinglefile(struct zfile *l)
 }
 #endif
 
+static bool writeneeded (const TCHAR *mode)
+{
+	return _tcschr (mode, 'w') || _tcschr (mode, 'a') || _tcschr (mode, '+') || _tcschr (mode, 't');
+}
+// map large read-only files, reads then become plain memcpy()s
+static void zfile_mapfile (struct zfile *l)
+{
+	if (!l->f || !l->mode || l->textmode || l->size < ZFILE_MAP_MIN || writeneeded (l->mode))
+		return;
+	l->mapped = (uae_u8*)uae_vm_map_file (l->f, l->size);
+	if (!l->mapped)
+		return;
+	l->dataseek = 1;
+	l->seek = 0;
+}
+
 static struct zfile *zfile_fopen_nozip (const TCHAR *name, const TCHAR *mode)
 {
 	struct zfile *l;
@@ -1669,10 +1960,6 @@ static struct zfile *openzip (const TCHAR *pname)
 	return 0;
 }
 
-static bool writeneeded (const TCHAR *mode)
-{
-	return _tcschr (mode, 'w') || _tcschr (mode, 'a') || _tcschr (mode, '+') || _tcschr (mode, 't');
-}
 bool zfile_needwrite (struct zfile *zf)
 {
 	if (!zf->mode)
@@ -1717,6 +2004,7 @@ static struct zfile *zfile_fopen_2 (const TCHAR *name, const TCHAR *mode, int ma
 		if (my_stat (l->name, &st))
 			l->size = st.size;
 		l->f = f;
+		zfile_mapfile (l);
 	}
 	return l;
 }
@@ -1963,9 +2251,24 @@ struct zfile *zfile_dup (struct zfile *zf)
 		return NULL;
 	if (zf->archiveparent)
 		checkarchiveparent (zf);
-	if (zf->userdata)
-		return NULL;
-	if (!zf->data && zf->dataseek) {
+	if (zf->userdata) {
+		struct zfile_gz *gz = (struct zfile_gz*)zf->userdata;
+		struct zfile *src;
+		if (zf->zfileread != zfile_gz_fread)
+			return NULL;
+		// independent inflate state on a duplicate of the packed file
+		src = zfile_dup (gz->src);
+		if (!src)
+			return NULL;
+		nzf = zfile_gunzip_lazy (src, zf->name, gz->point[0].in, (int)zf->size);
+		if (!nzf) {
+			zfile_fclose (src);
+			return NULL;
+		}
+		zfile_fseek (nzf, zf->seek, SEEK_SET);
+		return nzf;
+	}
+	if (!zf->data && zf->dataseek && !zf->mapped) {
 		nzf = zfile_create (zf, NULL);
 	} else if (zf->data) {
 		if (zf->size > INT_MAX) {
@@ -1996,6 +2299,9 @@ struct zfile *zfile_dup (struct zfile *zf)
 			return NULL;
 		nzf = zfile_create (zf, NULL);
 		nzf->f = ff;
+		nzf->mode = my_strdup (zf->mode);
+		nzf->size = zf->size;
+		zfile_mapfile (nzf);
 	}
 	zfile_fseek (nzf, zf->seek, SEEK_SET);
 	if (zf->name)
@@ -2003,7 +2309,8 @@ struct zfile *zfile_dup (struct zfile *zf)
 	if (nzf->zipname)
 		nzf->zipname = my_strdup (zf->zipname);
 	nzf->zfdmask = zf->zfdmask;
-	nzf->mode = my_strdup (zf->mode);
+	if (!nzf->mode)
+		nzf->mode = my_strdup (zf->mode);
 	nzf->size = zf->size;
 	return nzf;
 }
@@ -2023,7 +2330,7 @@ int zfile_exists (const TCHAR *name)
 
 int zfile_iscompressed (struct zfile *z)
 {
-	return z->data ? 1 : 0;
+	return z->data || z->zfileread == zfile_gz_fread ? 1 : 0;
 }
 
 struct zfile *zfile_fopen_empty (struct zfile *prev, const TCHAR *name, uae_u64 size)
@@ -2268,6 +2575,17 @@ size_t zfile_fread(void *b, size_t l1, size_t l2, struct zfile *z)
 		z->seek += l1 * l2;
 		return l2;
 	}
+	if (z->mapped) {
+		if (z->seek + l1 * l2 > z->size) {
+			if (l1)
+				l2 = (size_t)((z->size - z->seek) / l1);
+			else
+				l2 = 0;
+		}
+		memcpy (b, z->mapped + z->seek, l1 * l2);
+		z->seek += l1 * l2;
+		return l2;
+	}
 	if (z->parent && z->useparent) {
 		size_t ret;
 		uae_s64 v;
@@ -2334,7 +2652,8 @@ size_t zfile_fputs (struct zfile *z, const TCHAR *s)
 char *zfile_fgetsa (char *s, int size, struct zfile *z)
 {
 	checkarchiveparent (z);
-	if (z->data) {
+	uae_u8 *data = z->data ? z->data : z->mapped;
+	if (data) {
 		char *os = s;
 		int i;
 		for (i = 0; i < size - 1; i++) {
@@ -2343,7 +2662,7 @@ char *zfile_fgetsa (char *s, int size, struct zfile *z)
 					return NULL;
 				break;
 			}
-			*s = z->data[z->seek++];
+			*s = data[z->seek++];
 			if (*s == '\n') {
 				s++;
 				break;
@@ -2360,7 +2679,8 @@ char *zfile_fgetsa (char *s, int size, struct zfile *z)
 TCHAR *zfile_fgets (TCHAR *s, int size, struct zfile *z)
 {
 	checkarchiveparent (z);
-	if (z->data) {
+	uae_u8 *data = z->data ? z->data : z->mapped;
+	if (data) {
 		char s2[MAX_DPATH];
 		char *p = s2;
 		int i;
@@ -2370,7 +2690,7 @@ TCHAR *zfile_fgets (TCHAR *s, int size, struct zfile *z)
 					return NULL;
 				break;
 			}
-			*p = z->data[z->seek++];
+			*p = data[z->seek++];
 			if (*p == 0 && i == 0)
 				return NULL;
 			if (*p == '\n' || *p == 0) {
@@ -2423,9 +2743,10 @@ int zfile_getc (struct zfile *z)
 {
 	checkarchiveparent (z);
 	int out = -1;
-	if (z->data) {
+	uae_u8 *data = z->data ? z->data : z->mapped;
+	if (data) {
 		if (z->seek < z->size) {
-			out = z->data[z->seek++];
+			out = data[z->seek++];
 		}
 	} else {
 		out = fgetc (z->f);
@@ -2510,6 +2831,29 @@ int zfile_zcompress(struct zfile *f, void *src, size_t size)
 	return zs.total_out;
 }
 
+int zfile_zcompress_mem(void *dst, int dstsize, const void *src, int srcsize, int level)
+{
+	uLongf outlen = dstsize;
+
+	if (compress2((Bytef*)dst, &outlen, (const Bytef*)src, srcsize, level) != Z_OK)
+		return 0;
+	return (int)outlen;
+}
+
+int zfile_zuncompress_mem(void *dst, int dstsize, const void *src, int srcsize)
+{
+	uLongf outlen = dstsize;
+
+	if (uncompress((Bytef*)dst, &outlen, (const Bytef*)src, srcsize) != Z_OK)
+		return -1;
+	return (int)outlen;
+}
+
+int zfile_zcompress_bound(int size)
+{
+	return (int)compressBound(size);
+}
+
 TCHAR *zfile_getname (struct zfile *f)
 {
 	return f ? f->name : NULL;
@@ -2544,6 +2888,8 @@ uae_u32 zfile_crc32(struct zfile *f)
 		return 0;
 	if (f->data)
 		return get_crc32(f->data, (uae_u32)f->size);
+	if (f->mapped)
+		return get_crc32(f->mapped, (uae_u32)f->size);
 	pos = zfile_ftell32(f);
 	zfile_fseek(f, 0, SEEK_END);
 	size = zfile_ftell32(f);